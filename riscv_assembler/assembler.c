@@ -0,0 +1,382 @@
+// assembler.c
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#include "assembler.h"
+#include "instruction_defs.h"
+#include "instruction_args.h"
+#include "riscv_instructions.h"
+#include "source.h"
+
+/* ---------------------- Per-thread state ---------------------- */
+// Each thread assembles its own source, so labels and the diagnostic
+// sink must not be shared between threads.
+static _Thread_local label_t label_table[MAX_LABELS];
+static _Thread_local int label_count = 0;
+static _Thread_local FILE *diag_stream = NULL;
+static _Thread_local int diag_count = 0;
+static _Thread_local object_refs_t *object_refs = NULL;
+static _Thread_local int current_line_no = 0;
+static _Thread_local const char *current_file = NULL;
+static _Thread_local int image_xlen = 32;
+
+typedef struct {
+    uint32_t pc;
+    char symbol[MAX_LABEL_LEN];
+} pcrel_hi_t;
+
+// Each entry needs a label at its pc, so MAX_LABELS bounds the table
+static _Thread_local pcrel_hi_t pcrel_hi_table[MAX_LABELS];
+static _Thread_local int pcrel_hi_count = 0;
+
+/* ---------------------- Diagnostics ---------------------- */
+void set_diag_stream(FILE *stream) {
+    diag_stream = stream;
+}
+
+void diag(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(diag_stream ? diag_stream : stdout, fmt, ap);
+    va_end(ap);
+    diag_count++;
+}
+
+// "file:line: " of the instruction being encoded, outside of it nothing
+static FILE *located_stream(void) {
+    FILE *out = diag_stream ? diag_stream : stdout;
+    if (current_file)
+        fprintf(out, "%s:%d: ", current_file, current_line_no);
+    return out;
+}
+
+void diag_line(const char *fmt, ...) {
+    FILE *out = located_stream();
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(out, fmt, ap);
+    va_end(ap);
+    diag_count++;
+}
+
+void warn(const char *fmt, ...) {
+    FILE *out = located_stream();
+    va_list ap;
+    fprintf(out, "Warning: ");
+    va_start(ap, fmt);
+    vfprintf(out, fmt, ap);
+    va_end(ap);
+}
+
+/* ---------------------- Object references ---------------------- */
+void set_object_refs(object_refs_t *refs) {
+    object_refs = refs;
+}
+
+void free_object_refs(object_refs_t *refs) {
+    free(refs->relocs);
+    free(refs->globals);
+    memset(refs, 0, sizeof(*refs));
+}
+
+int defer_label(const char *name, reloc_kind_t kind, uint32_t pc) {
+    return defer_pcrel_lo(name, kind, pc, pc);
+}
+
+int defer_pcrel_lo(const char *name, reloc_kind_t kind, uint32_t pc, uint32_t anchor) {
+    object_refs_t *refs = object_refs;
+    if (!refs)
+        return 0;
+
+    if (refs->num_relocs == refs->relocs_capacity) {
+        size_t new_capacity = refs->relocs_capacity ? refs->relocs_capacity * 2 : 32;
+        reloc_t *grown = realloc(refs->relocs, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        refs->relocs = grown;
+        refs->relocs_capacity = new_capacity;
+    }
+
+    reloc_t *r = &refs->relocs[refs->num_relocs++];
+    snprintf(r->symbol, sizeof(r->symbol), "%s", name);
+    r->pc = pc;
+    r->anchor = anchor;
+    r->line_no = current_line_no;
+    r->kind = kind;
+    return 1;
+}
+
+/* ---------------------- auipc / %pcrel_lo pairs ---------------------- */
+void record_pcrel_hi(uint32_t pc, const char *symbol) {
+    int labelled = 0;
+    for (int i = 0; i < label_count; i++)
+        if (label_table[i].address == pc)
+            labelled = 1;
+    if (!labelled || pcrel_hi_count >= MAX_LABELS)
+        return;
+
+    pcrel_hi_table[pcrel_hi_count].pc = pc;
+    snprintf(pcrel_hi_table[pcrel_hi_count].symbol, MAX_LABEL_LEN, "%s", symbol);
+    pcrel_hi_count++;
+}
+
+const char *find_pcrel_hi(uint32_t pc) {
+    for (int i = 0; i < pcrel_hi_count; i++)
+        if (pcrel_hi_table[i].pc == pc)
+            return pcrel_hi_table[i].symbol;
+    return NULL;
+}
+
+static int add_global(const char *name) {
+    object_refs_t *refs = object_refs;
+
+    if (refs->num_globals == refs->globals_capacity) {
+        size_t new_capacity = refs->globals_capacity ? refs->globals_capacity * 2 : 16;
+        char (*grown)[MAX_LABEL_LEN] = realloc(refs->globals, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        refs->globals = grown;
+        refs->globals_capacity = new_capacity;
+    }
+    snprintf(refs->globals[refs->num_globals++], MAX_LABEL_LEN, "%s", name);
+    return 1;
+}
+
+/* ---------------------- Include expansion ---------------------- */
+// A source line together with the unit it came from, for diagnostics
+typedef struct {
+    const source_line_t *line;
+    const source_unit_t *unit;
+} flat_line_t;
+
+typedef struct {
+    flat_line_t *lines;
+    size_t count;
+    size_t capacity;
+    const source_unit_t **held;     // cached include units to release when done
+    size_t num_held;
+    size_t held_capacity;
+} flat_source_t;
+
+static int hold_unit(flat_source_t *flat, const source_unit_t *unit) {
+    if (flat->num_held == flat->held_capacity) {
+        size_t new_capacity = flat->held_capacity ? flat->held_capacity * 2 : 16;
+        const source_unit_t **grown = realloc(flat->held, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        flat->held = grown;
+        flat->held_capacity = new_capacity;
+    }
+    flat->held[flat->num_held++] = unit;
+    return 1;
+}
+
+static void free_flat(flat_source_t *flat) {
+    for (size_t i = 0; i < flat->num_held; i++)
+        release_include_unit(flat->held[i]);
+    free(flat->held);
+    free(flat->lines);
+}
+
+static int push_line(flat_source_t *flat, const source_line_t *line, const source_unit_t *unit) {
+    if (flat->count == flat->capacity) {
+        size_t new_capacity = flat->capacity ? flat->capacity * 2 : 256;
+        flat_line_t *grown = realloc(flat->lines, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        flat->lines = grown;
+        flat->capacity = new_capacity;
+    }
+    flat->lines[flat->count].line = line;
+    flat->lines[flat->count].unit = unit;
+    flat->count++;
+    return 1;
+}
+
+// Splice included units into one line list. `stack` holds the canonical
+// paths of the units currently being expanded, which is how include
+// cycles are detected.
+static int expand_unit(flat_source_t *flat, const source_unit_t *unit,
+                       const char **stack, int depth)
+{
+    for (size_t i = 0; i < unit->num_lines; i++) {
+        const source_line_t *line = &unit->lines[i];
+
+        if (line->kind != SRC_INCLUDE) {
+            if (!push_line(flat, line, unit)) {
+                diag("Out of memory\n");
+                return 0;
+            }
+            continue;
+        }
+
+        if (!line->text) {
+            diag("%s:%d: Malformed .include, expected .include \"file\"\n", unit->path, line->line_no);
+            continue;
+        }
+
+        char path[MAX_PATH_LEN];
+        const source_unit_t *included = NULL;
+        if (resolve_include(line->text, unit, path, sizeof(path)))
+            included = get_include_unit(path);
+        if (!included) {
+            diag("%s:%d: Cannot open include file \"%s\"\n", unit->path, line->line_no, line->text);
+            continue;
+        }
+        if (!hold_unit(flat, included)) {
+            release_include_unit(included);
+            diag("Out of memory\n");
+            return 0;
+        }
+
+        int cycle = 0;
+        for (int d = 0; d <= depth; d++)
+            if (strcmp(stack[d], included->path) == 0)
+                cycle = 1;
+        if (cycle) {
+            diag("%s:%d: Include cycle: \"%s\" is already being included\n",
+                 unit->path, line->line_no, line->text);
+            continue;
+        }
+        if (depth + 1 >= MAX_INCLUDE_DEPTH) {
+            diag("%s:%d: Includes nested too deeply\n", unit->path, line->line_no);
+            continue;
+        }
+
+        stack[depth + 1] = included->path;   // cached units carry canonical paths
+        if (!expand_unit(flat, included, stack, depth + 1))
+            return 0;
+    }
+    return 1;
+}
+
+/* ---------------------- Assemble ---------------------- */
+int assemble_stream(FILE *asm_file, const char *file_name, emit_fn_t emit, void *ctx)
+{
+    uint32_t pc = 0;
+
+    label_count = 0;
+    pcrel_hi_count = 0;
+    diag_count = 0;
+
+    source_unit_t *unit = tokenize_stream(asm_file, file_name);
+    if (!unit) {
+        diag("Out of memory\n");
+        return -1;
+    }
+
+    /* Tokenized includes are shared; this only splices them in */
+    flat_source_t flat = {0};
+    const char *stack[MAX_INCLUDE_DEPTH];
+    char top_path[MAX_PATH_LEN];
+    stack[0] = canonical_path(file_name, top_path, sizeof(top_path)) ? top_path : file_name;
+    if (!expand_unit(&flat, unit, stack, 0)) {
+        free_flat(&flat);
+        free_unit(unit);
+        return -1;
+    }
+
+    /* ---------------------- First pass: collect labels ---------------------- */
+    for (size_t n = 0; n < flat.count; n++) {
+        const source_line_t *line = flat.lines[n].line;
+
+        if (line->kind == SRC_LABEL) {
+            if (label_count < MAX_LABELS) {
+                snprintf(label_table[label_count].name, MAX_LABEL_LEN, "%s", line->text);
+                label_table[label_count].address = pc;
+                label_count++;
+            } else {
+                diag("%s:%d: Label table full!\n", flat.lines[n].unit->path, line->line_no);
+                free_flat(&flat);
+                free_unit(unit);
+                return -1;
+            }
+            continue; // label-only line
+        }
+
+        if (line->kind == SRC_INSTR)
+            pc += 4; // increment PC per instruction
+    }
+
+    pc = 0; // reset PC for second pass
+
+    /* ---------------------- Second pass: encode instructions ---------------------- */
+    for (size_t n = 0; n < flat.count; n++) {
+        const source_line_t *line = flat.lines[n].line;
+        const char *where = flat.lines[n].unit->path;
+
+        if (line->kind == SRC_GLOBAL && object_refs) {
+            if (!add_global(line->text))
+                diag("%s:%d: Out of memory\n", where, line->line_no);
+            continue;
+        }
+
+        if (line->kind != SRC_INSTR) continue; // skip label-only lines
+
+        current_line_no = line->line_no;
+        current_file = where;
+
+        /* Find instruction */
+        const instr_def_t *def = line->def;
+        if (!def) {
+            diag("%s:%d: Unknown instruction: %s\n", where, line->line_no, line->text);
+            continue;
+        }
+        def = xlen_variant(def, image_xlen);
+        if (!def) {
+            diag("%s:%d: %s is not available on RV%d\n", where, line->line_no, line->mnemonic, image_xlen);
+            continue;
+        }
+
+        /* Parse operands */
+        instr_args_t args = {0};
+        args.current_pc = pc; // assign PC before parsing
+
+        if (!def->parser(def, line->operands, &args)) {
+            diag("%s:%d: Parse error: %s\n", where, line->line_no, line->text);
+            continue;
+        }
+
+        /* Encode instruction */
+        uint32_t machine = def->encoder(def, &args);
+
+        emit(ctx, def, line->text, machine);
+
+        pc += 4; // increment PC
+    }
+
+    current_file = NULL;
+    free_flat(&flat);
+    free_unit(unit);
+    return diag_count;
+}
+
+/* ---------------------- Find instruction ---------------------- */
+instr_def_t *find_instruction(const char *mnemonic) {
+    return lookup_mnemonic(mnemonic); // perfect hash over every extension
+}
+
+void set_xlen(int xlen) {
+    image_xlen = xlen;
+}
+
+int get_xlen(void) {
+    return image_xlen;
+}
+
+/* ---------------------- Labels ---------------------- */
+const label_t *get_labels(int *count) {
+    *count = label_count;
+    return label_table;
+}
+
+/* ---------------------- Find label ---------------------- */
+int find_label(const char *name, uint32_t *address) {
+    for (int i = 0; i < label_count; i++) {
+        if (strcmp(label_table[i].name, name) == 0) {
+            *address = label_table[i].address;
+            return 1;
+        }
+    }
+    return 0;
+}
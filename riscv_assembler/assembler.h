@@ -0,0 +1,99 @@
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "instruction_defs.h"
+
+#define MAX_LINE_LEN 128
+#define MAX_LABELS 256
+#define MAX_LABEL_LEN 64
+
+typedef struct {
+    char name[MAX_LABEL_LEN];
+    uint32_t address;
+} label_t;
+
+typedef enum {
+    RELOC_B,            // branch offset (B-type)
+    RELOC_J,            // jal offset (J-type)
+    RELOC_PCREL_HI20,   // auipc: upper 20 bits of the pc-relative offset
+    RELOC_PCREL_LO12_I, // %pcrel_lo in an I-type immediate (addi, jalr, loads)
+    RELOC_PCREL_LO12_S  // %pcrel_lo in a store offset
+} reloc_kind_t;
+
+// Reference to a label that is not defined in the source being assembled
+typedef struct {
+    char symbol[MAX_LABEL_LEN];
+    uint32_t pc;        // offset of the referencing instruction in its object
+    uint32_t anchor;    // offset the pc-relative value is measured from: pc, or
+                        // for %pcrel_lo the auipc it completes
+    int line_no;
+    reloc_kind_t kind;
+} reloc_t;
+
+// What an object exports and what it still needs from other objects
+typedef struct {
+    reloc_t *relocs;
+    size_t num_relocs;
+    size_t relocs_capacity;
+    char (*globals)[MAX_LABEL_LEN];   // names listed in .globl/.global
+    size_t num_globals;
+    size_t globals_capacity;
+} object_refs_t;
+
+// Called once per encoded instruction with its definition and (comment-stripped) source line
+typedef void (*emit_fn_t)(void *ctx, const instr_def_t *def, const char *line, uint32_t machine);
+
+// Two-pass assembly of one source stream; file_name is used for diagnostics
+// and as the base for relative .include paths.
+// Returns the number of diagnostics reported, or -1 on a fatal error.
+// The label table is per thread, so several threads may assemble at once.
+int assemble_stream(FILE *asm_file, const char *file_name, emit_fn_t emit, void *ctx);
+
+instr_def_t *find_instruction(const char *mnemonic);
+int find_label(const char *name, uint32_t *address);
+
+// While set, references to unknown labels are recorded in `refs` instead of
+// being errors, and .globl names are collected. NULL restores standalone mode.
+void set_object_refs(object_refs_t *refs);
+void free_object_refs(object_refs_t *refs);
+
+// Record a relocation for an unknown label. Returns 0 in standalone mode.
+int defer_label(const char *name, reloc_kind_t kind, uint32_t pc);
+// Same for the %pcrel_lo half of an auipc pair, measured from the auipc at `anchor`
+int defer_pcrel_lo(const char *name, reloc_kind_t kind, uint32_t pc, uint32_t anchor);
+
+// auipc instructions with a label operand, so that a later %pcrel_lo(anchor)
+// can find the symbol its auipc refers to. Only labelled auipcs are kept.
+void record_pcrel_hi(uint32_t pc, const char *symbol);
+const char *find_pcrel_hi(uint32_t pc);
+
+// Upper 20 bits for auipc, rounded so that a signed low 12-bit part completes the offset
+static inline int32_t pcrel_hi20(int32_t offset) {
+    return (int32_t)((((uint32_t)offset + 0x800) >> 12) & 0xFFFFF);
+}
+
+// Signed low 12 bits that complete pcrel_hi20(offset)
+static inline int32_t pcrel_lo12(int32_t offset) {
+    return (int32_t)((uint32_t)offset - (((uint32_t)offset + 0x800) & 0xFFFFF000u));
+}
+
+// Labels collected by the last assemble_stream() call on this thread, in source order
+const label_t *get_labels(int *count);
+// Target XLEN (32 or 64) for assemble_stream() calls on this thread; 32 by
+// default. It selects XLEN-specific encodings and the shift amount range,
+// and RV64-only instructions are errors in an RV32 image.
+void set_xlen(int xlen);
+int get_xlen(void);
+
+// Diagnostics go to stdout unless redirected for the calling thread
+void set_diag_stream(FILE *stream);
+void diag(const char *fmt, ...);
+// Like diag(), prefixed with the source line being encoded (file:line:)
+void diag_line(const char *fmt, ...);
+// Like diag_line(), but not counted as an error
+void warn(const char *fmt, ...);
+
+#endif // ASSEMBLER_H
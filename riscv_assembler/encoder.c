@@ -11,6 +11,17 @@ uint32_t encode_R(int funct7, int rs2, int rs1, int funct3, int rd, int opcode)
            (opcode & 0x7F);
 }
 
+/* Unary R-type: clz, rev8 */
+//| funct7 + rs2 = funct12 (12b) | rs1 (5b) | funct3 (3b) | rd (5b) | opcode (7b) |
+uint32_t encode_R1(int funct12, int rs1, int funct3, int rd, int opcode)
+{
+    return ((funct12 & 0xFFF) << 20) |
+           ((rs1    & 0x1F ) << 15) |
+           ((funct3 & 0x07 ) << 12) |
+           ((rd     & 0x1F ) << 7 ) |
+           (opcode  & 0x7F);
+}
+
 /* I-type: lw */
 uint32_t encode_I(int imm, int rs1, int funct3, int rd, int opcode)
 {
@@ -23,10 +34,11 @@ uint32_t encode_I(int imm, int rs1, int funct3, int rd, int opcode)
 
 /* I7-type encoder: e.g., slli, srli, srai */
 //| funct7 (7b) | shamt (5b) | rs1 (5b) | funct3 (3b) | rd (5b) | opcode (7b) |
+// A 6-bit shamt (RV64 shamtd) takes bit 25, which funct7 then leaves clear.
 uint32_t encode_I7(int funct7, int shamt, int rs1, int funct3, int rd, int opcode)
 {
     return ((funct7 & 0x7F) << 25) |   // bits 31:25
-           ((shamt  & 0x1F) << 20) |   // bits 24:20
+           ((shamt  & 0x3F) << 20) |   // bits 25:20
            ((rs1    & 0x1F) << 15) |   // bits 19:15
            ((funct3 & 0x07) << 12) |   // bits 14:12
            ((rd     & 0x1F) << 7 ) |   // bits 11:7
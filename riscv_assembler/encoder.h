@@ -5,6 +5,8 @@
 
 uint32_t encode_R(int funct7, int rs2, int rs1, int funct3, int rd, int opcode);
 
+uint32_t encode_R1(int funct12, int rs1, int funct3, int rd, int opcode);
+
 uint32_t encode_I(int imm, int rs1, int funct3, int rd, int opcode);
 
 uint32_t encode_I7(int funct7, int shamt, int rs1, int funct3, int rd, int opcode);
@@ -0,0 +1,586 @@
+// gen_tables.c
+// Builds the instruction tables, the perfect-hash mnemonic index and the
+// mask/match decode table from opcode files in the riscv-opcodes format.
+//
+//   gcc -O2 gen_tables.c -o gen_tables
+//   ./gen_tables opcodes .
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_EXTENSIONS 32
+#define MAX_FILES 8
+#define MAX_INSTRS 1024
+#define MAX_NAME 32
+#define MAX_LINE 512
+#define MAX_PATH 1024
+
+/* ---------------------- Types ---------------------- */
+typedef struct {
+    char enum_name[MAX_NAME];
+    char name[MAX_NAME];
+    char table[MAX_NAME];         // "" = no instructions yet
+    char files[MAX_FILES][MAX_NAME];
+    int num_files;
+    char comment[128];
+} extension_t;
+
+// Operand syntax; each one selects a parser/encoder pair in riscv_instructions.c
+typedef enum {
+    SYN_R,        // rd, rs1, rs2
+    SYN_R1,       // rd, rs1          (unary, funct12 fixed)
+    SYN_I,        // rd, rs1, imm
+    SYN_LOAD,     // rd, imm(rs1)
+    SYN_I7,       // rd, rs1, shamt
+    SYN_S,        // rs2, imm(rs1)
+    SYN_B,        // rs1, rs2, label
+    SYN_U,        // rd, imm | label
+    SYN_J,        // rd, label
+    SYN_CSR,      // rd, csr, rs1
+    SYN_CSRI,     // rd, csr, uimm
+    SYN_SYSTEM,   // no operands      (funct12 fixed)
+    SYN_COUNTER,  // rd               (csrrs rd, funct12, x0)
+    NUM_SYNTAXES
+} syntax_t;
+
+typedef struct {
+    const char *format;
+    const char *encoder;
+    const char *parser;
+    int max_shamt_bits;     // widest shamt field the encoder can place
+} syntax_info_t;
+
+static const syntax_info_t syntax_info[NUM_SYNTAXES] = {
+    [SYN_R]       = {"TYPE_R",  "encode_r_type",  "parse_r_type"},
+    [SYN_R1]      = {"TYPE_R",  "encode_r1_type", "parse_r1_type"},
+    [SYN_I]       = {"TYPE_I",  "encode_i_type",  "parse_i_type"},
+    [SYN_LOAD]    = {"TYPE_I",  "encode_i_type",  "parse_load"},
+    [SYN_I7]      = {"TYPE_I7", "encode_i7_type", "parse_i7_type", 6},
+    [SYN_S]       = {"TYPE_S",  "encode_s_type",  "parse_s_type"},
+    [SYN_B]       = {"TYPE_B",  "encode_b_type",  "parse_b_type"},
+    [SYN_U]       = {"TYPE_U",  "encode_u_type",  "parse_u_type"},
+    [SYN_J]       = {"TYPE_J",  "encode_j_type",  "parse_j_type"},
+    [SYN_CSR]     = {"TYPE_I",  "encode_i_type",  "parse_csr_reg"},
+    [SYN_CSRI]    = {"TYPE_I",  "encode_i_type",  "parse_csr_imm"},
+    [SYN_SYSTEM]  = {"TYPE_I",  "encode_i_type",  "parse_system"},
+    [SYN_COUNTER] = {"TYPE_I",  "encode_i_type",  "parse_counter"},
+};
+
+// Operand fields of the riscv-opcodes format and the bits they occupy
+typedef struct {
+    const char *name;
+    int hi, lo;
+} arg_field_t;
+
+static const arg_field_t arg_fields[] = {
+    {"rd", 11, 7},        {"rs1", 19, 15},      {"rs2", 24, 20},
+    {"imm12", 31, 20},    {"imm12hi", 31, 25},  {"imm12lo", 11, 7},
+    {"bimm12hi", 31, 25}, {"bimm12lo", 11, 7},
+    {"imm20", 31, 12},    {"jimm20", 31, 12},
+    {"shamtw", 24, 20},   {"shamtd", 25, 20},
+    {"csr", 31, 20},      {"zimm", 19, 15},
+};
+
+typedef struct {
+    char mnemonic[MAX_NAME];
+    int ext;                // index into extensions
+    int index;              // position in its table
+    int pseudo;             // $pseudo_op: assembled, never decoded
+    int xlen;               // 32/64 when read from an rv32_/rv64_ file, else 0
+    int variant;            // same mnemonic for the other XLEN, or -1
+    syntax_t syntax;
+    int shamt_bits;         // width of the shamtw/shamtd field, 0 if none
+    uint32_t mask, match;
+} instr_t;
+
+/* ---------------------- Globals ---------------------- */
+static extension_t extensions[MAX_EXTENSIONS];
+static int num_extensions = 0;
+static instr_t instrs[MAX_INSTRS];
+static int num_instrs = 0;
+
+/* ---------------------- Helpers ---------------------- */
+static void fail(const char *file, int line_no, const char *msg, const char *detail) {
+    fprintf(stderr, "%s:%d: %s%s%s\n", file, line_no, msg, detail ? ": " : "", detail ? detail : "");
+    exit(1);
+}
+
+static uint32_t bit_range(int hi, int lo) {
+    return (uint32_t)((((uint64_t)1 << (hi - lo + 1)) - 1) << lo);
+}
+
+static int popcount(uint32_t v) {
+    int n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+}
+
+// Split on whitespace in place; returns the token count
+static int split(char *line, char **tokens, int max_tokens) {
+    int n = 0;
+    char *p = strtok(line, " \t\r\n");
+    while (p && n < max_tokens) {
+        tokens[n++] = p;
+        p = strtok(NULL, " \t\r\n");
+    }
+    return n;
+}
+
+// Must match mnemonic_hash() in the generated instr_tables.c
+static uint32_t mnemonic_hash(uint32_t seed, const char *s) {
+    uint32_t h = 2166136261u ^ seed;   // FNV-1a
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* ---------------------- Manifest ---------------------- */
+static void read_manifest(const char *dir) {
+    char path[MAX_PATH], line[MAX_LINE];
+    snprintf(path, sizeof(path), "%s/extensions", dir);
+    FILE *file = fopen(path, "r");
+    if (!file) fail(path, 0, "Cannot open manifest", NULL);
+
+    int line_no = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        extension_t *ext = &extensions[num_extensions];
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment++ = '\0';
+            while (isspace((unsigned char)*comment)) comment++;
+            comment[strcspn(comment, "\r\n")] = '\0';
+        }
+
+        char *tokens[3 + MAX_FILES];
+        int n = split(line, tokens, 3 + MAX_FILES);
+        if (n == 0) continue;
+        if (n < 3) fail(path, line_no, "Expected: enum name table [files...]", NULL);
+        if (num_extensions == MAX_EXTENSIONS) fail(path, line_no, "Too many extensions", NULL);
+
+        memset(ext, 0, sizeof(*ext));
+        snprintf(ext->enum_name, sizeof(ext->enum_name), "%s", tokens[0]);
+        snprintf(ext->name, sizeof(ext->name), "%s", tokens[1]);
+        if (strcmp(tokens[2], "-") != 0)
+            snprintf(ext->table, sizeof(ext->table), "%s", tokens[2]);
+        for (int i = 3; i < n; i++)
+            snprintf(ext->files[ext->num_files++], MAX_NAME, "%s", tokens[i]);
+        if (comment)
+            snprintf(ext->comment, sizeof(ext->comment), "%s", comment);
+
+        if (ext->table[0] && ext->num_files == 0)
+            fail(path, line_no, "Table without opcode files", ext->table);
+        num_extensions++;
+    }
+    fclose(file);
+}
+
+/* ---------------------- Opcode files ---------------------- */
+static syntax_t classify(const char *args, uint32_t mask, uint8_t opcode, const char *file, int line_no) {
+    if (strcmp(args, "rd rs1 rs2") == 0)               return SYN_R;
+    if (strcmp(args, "rd rs1 imm12") == 0)             return opcode == 0x03 ? SYN_LOAD : SYN_I;
+    if (strcmp(args, "rd rs1 shamtw") == 0 ||
+        strcmp(args, "rd rs1 shamtd") == 0)            return SYN_I7;
+    if (strcmp(args, "imm12hi rs1 rs2 imm12lo") == 0)  return SYN_S;
+    if (strcmp(args, "bimm12hi rs1 rs2 bimm12lo") == 0) return SYN_B;
+    if (strcmp(args, "rd imm20") == 0)                 return SYN_U;
+    if (strcmp(args, "rd jimm20") == 0)                return SYN_J;
+    if (strcmp(args, "rd rs1 csr") == 0)               return SYN_CSR;
+    if (strcmp(args, "rd csr zimm") == 0)              return SYN_CSRI;
+    if (strcmp(args, "rd rs1") == 0 && (mask & 0xFFF00000) == 0xFFF00000)   return SYN_R1;
+    if (strcmp(args, "") == 0 && (mask & 0xFFFFFF80) == 0xFFFFFF80)         return SYN_SYSTEM;
+    if (strcmp(args, "rd") == 0 && (mask & 0xFFFFF000) == 0xFFFFF000)       return SYN_COUNTER;
+    fail(file, line_no, "Unsupported operand list", args[0] ? args : "(none)");
+    return SYN_R;
+}
+
+static void read_opcode_file(const char *dir, int ext_index, const char *name) {
+    char path[MAX_PATH], line[MAX_LINE];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *file = fopen(path, "r");
+    if (!file) fail(path, 0, "Cannot open opcode file", NULL);
+
+    int line_no = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *tokens[32];
+        int n = split(line, tokens, 32);
+        if (n == 0) continue;
+
+        int t = 0, pseudo = 0;
+        if (strcmp(tokens[0], "$pseudo_op") == 0) {
+            if (n < 3) fail(path, line_no, "Malformed $pseudo_op", NULL);
+            pseudo = 1;
+            t = 2;               // skip "<ext>::<base instruction>"
+        } else if (tokens[0][0] == '$') {
+            fail(path, line_no, "Unsupported directive", tokens[0]);
+        }
+
+        if (num_instrs == MAX_INSTRS) fail(path, line_no, "Too many instructions", NULL);
+        instr_t *in = &instrs[num_instrs];
+        memset(in, 0, sizeof(*in));
+        if (strlen(tokens[t]) >= MAX_NAME) fail(path, line_no, "Mnemonic too long", tokens[t]);
+        strcpy(in->mnemonic, tokens[t++]);
+        in->ext = ext_index;
+        in->pseudo = pseudo;
+        in->xlen = strncmp(name, "rv32_", 5) == 0 ? 32 : strncmp(name, "rv64_", 5) == 0 ? 64 : 0;
+        in->variant = -1;
+
+        char args[MAX_LINE] = "";
+        uint32_t arg_mask = 0;
+        for (; t < n; t++) {
+            char *eq = strchr(tokens[t], '=');
+            if (!eq) {
+                // Operand field
+                size_t f = 0;
+                while (f < sizeof(arg_fields) / sizeof(arg_fields[0]) && strcmp(arg_fields[f].name, tokens[t]) != 0)
+                    f++;
+                if (f == sizeof(arg_fields) / sizeof(arg_fields[0]))
+                    fail(path, line_no, "Unknown operand field", tokens[t]);
+                arg_mask |= bit_range(arg_fields[f].hi, arg_fields[f].lo);
+                if (strncmp(tokens[t], "shamt", 5) == 0)
+                    in->shamt_bits = arg_fields[f].hi - arg_fields[f].lo + 1;
+                if (args[0]) strcat(args, " ");
+                strcat(args, tokens[t]);
+                continue;
+            }
+
+            // Fixed field: hi..lo=value or bit=value
+            int hi, lo;
+            *eq = '\0';
+            if (sscanf(tokens[t], "%d..%d", &hi, &lo) != 2) {
+                if (sscanf(tokens[t], "%d", &hi) != 1) fail(path, line_no, "Malformed bit range", tokens[t]);
+                lo = hi;
+            }
+            if (hi > 31 || lo < 0 || hi < lo) fail(path, line_no, "Bad bit range", tokens[t]);
+
+            char *end;
+            unsigned long value = strtoul(eq + 1, &end, 0);
+            uint32_t bits = bit_range(hi, lo);
+            if (*end || (value << lo & ~(uint64_t)bits)) fail(path, line_no, "Bad field value", eq + 1);
+            if (in->mask & bits) fail(path, line_no, "Overlapping fields", tokens[t]);
+            in->mask  |= bits;
+            in->match |= (uint32_t)(value << lo);
+        }
+
+        if ((in->mask & arg_mask) || (in->mask | arg_mask) != 0xFFFFFFFF)
+            fail(path, line_no, "Fields do not cover all 32 bits exactly once", in->mnemonic);
+        if ((in->mask & 0x7F) != 0x7F)
+            fail(path, line_no, "Opcode bits 6..0 must be fixed", in->mnemonic);
+
+        in->syntax = classify(args, in->mask, in->match & 0x7F, path, line_no);
+        if (in->shamt_bits > syntax_info[in->syntax].max_shamt_bits)
+            fail(path, line_no, "Shift amount field is wider than its encoder", in->mnemonic);
+
+        // A mnemonic may appear twice only as an RV32 and an RV64 encoding
+        // with the same operands, so the assembler can pick one per image
+        for (int i = 0; i < num_instrs; i++) {
+            instr_t *other = &instrs[i];
+            if (strcmp(other->mnemonic, in->mnemonic) != 0)
+                continue;
+            if (!in->xlen || !other->xlen || in->xlen == other->xlen || other->variant >= 0 ||
+                in->syntax != other->syntax || in->ext != other->ext)
+                fail(path, line_no, "Duplicate mnemonic", in->mnemonic);
+            other->variant = num_instrs;
+            in->variant = i;
+        }
+        num_instrs++;
+    }
+    fclose(file);
+}
+
+/* ---------------------- Perfect hash ---------------------- */
+// Keys are the distinct mnemonics; an RV32/RV64 pair is indexed by its RV32 half
+static int is_hashed(const instr_t *in) {
+    return in->variant < 0 || in->xlen == 32;
+}
+
+// Hash and displace: each bucket of keys gets the first seed that sends all
+// of them to free slots, so a lookup is two hashes and one string compare.
+static int build_perfect_hash(int num_buckets, int num_slots, uint16_t *seeds, int *slots) {
+    int *bucket_of = malloc(num_instrs * sizeof(int));
+    int *order = malloc(num_buckets * sizeof(int));
+    int *size = calloc(num_buckets, sizeof(int));
+    int ok = bucket_of && order && size;
+
+    for (int i = 0; ok && i < num_instrs; i++) {
+        if (!is_hashed(&instrs[i])) { bucket_of[i] = -1; continue; }
+        bucket_of[i] = mnemonic_hash(0, instrs[i].mnemonic) & (num_buckets - 1);
+        size[bucket_of[i]]++;
+    }
+    for (int b = 0; b < num_buckets; b++) order[b] = b;
+    // Largest buckets first (insertion sort keeps this deterministic)
+    for (int i = 1; ok && i < num_buckets; i++)
+        for (int j = i; j > 0 && size[order[j]] > size[order[j - 1]]; j--) {
+            int tmp = order[j]; order[j] = order[j - 1]; order[j - 1] = tmp;
+        }
+
+    for (int s = 0; s < num_slots; s++) slots[s] = -1;
+    memset(seeds, 0, num_buckets * sizeof(*seeds));
+
+    for (int o = 0; ok && o < num_buckets && size[order[o]]; o++) {
+        int b = order[o], placed = 0;
+        for (uint32_t seed = 1; seed <= 0xFFFF && !placed; seed++) {
+            int taken[64], count = 0;
+            placed = 1;
+            for (int i = 0; i < num_instrs && placed; i++) {
+                if (bucket_of[i] != b) continue;
+                int slot = mnemonic_hash(seed, instrs[i].mnemonic) & (num_slots - 1);
+                if (slots[slot] >= 0) placed = 0;
+                for (int k = 0; k < count; k++)
+                    if (taken[k] == slot) placed = 0;
+                if (count < 64) taken[count++] = slot;
+                else placed = 0;
+            }
+            if (!placed) continue;
+            seeds[b] = (uint16_t)seed;
+            for (int i = 0; i < num_instrs; i++)
+                if (bucket_of[i] == b)
+                    slots[mnemonic_hash(seed, instrs[i].mnemonic) & (num_slots - 1)] = i;
+        }
+        if (!placed) ok = 0;
+    }
+
+    free(bucket_of);
+    free(order);
+    free(size);
+    return ok;
+}
+
+/* ---------------------- Output ---------------------- */
+static FILE *open_output(const char *dir, const char *name) {
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *file = fopen(path, "w");
+    if (!file) fail(path, 0, "Cannot create output file", NULL);
+    fprintf(file, "// %s\n// Generated by gen_tables from opcodes/. Do not edit.\n", name);
+    return file;
+}
+
+static void write_extensions_header(const char *dir) {
+    FILE *file = open_output(dir, "isa_extensions.h");
+    fprintf(file, "#ifndef ISA_EXTENSIONS_H\n#define ISA_EXTENSIONS_H\n\n");
+    fprintf(file, "typedef enum {\n");
+    for (int e = 0; e < num_extensions; e++) {
+        fprintf(file, "    %s,", extensions[e].enum_name);
+        if (extensions[e].comment[0])
+            fprintf(file, "%*s// %s", (int)(16 - strlen(extensions[e].enum_name)), "", extensions[e].comment);
+        fprintf(file, "\n");
+    }
+    fprintf(file, "    NUM_ISA_EXTENSIONS\n} isa_extension_t;\n\n");
+
+    fprintf(file, "// Display names, indexed by isa_extension_t\n#define ISA_EXTENSION_NAMES");
+    for (int e = 0; e < num_extensions; e++)
+        fprintf(file, "%s \"%s\"", e ? "," : "", extensions[e].name);
+    fprintf(file, "\n\n#endif // ISA_EXTENSIONS_H\n");
+    fclose(file);
+}
+
+static void write_tables_header(const char *dir) {
+    FILE *file = open_output(dir, "instr_tables.h");
+    fprintf(file, "#ifndef INSTR_TABLES_H\n#define INSTR_TABLES_H\n\n");
+    fprintf(file, "#include <stdint.h>\n#include <stddef.h>\n\n#include \"instruction_defs.h\"\n\n");
+
+    for (int e = 0; e < num_extensions; e++) {
+        if (!extensions[e].table[0]) continue;
+        fprintf(file, "// %s\n", extensions[e].name);
+        fprintf(file, "extern instr_def_t %s_instructions[];\n", extensions[e].table);
+        fprintf(file, "extern size_t num_%s_instructions;\n\n", extensions[e].table);
+    }
+
+    fprintf(file, "// instr_def_t.id runs over every table, for per-instruction side tables\n");
+    fprintf(file, "#define NUM_INSTRUCTIONS %d\n\n", num_instrs);
+    fprintf(file, "// Constant-time mnemonic lookup through a perfect hash. Returns NULL if unknown.\n");
+    fprintf(file, "instr_def_t *lookup_mnemonic(const char *mnemonic);\n\n");
+    fprintf(file, "// The definition to use in an XLEN-bit image: `def` itself unless its\n");
+    fprintf(file, "// encoding is XLEN-specific. NULL if there is no encoding for that XLEN.\n");
+    fprintf(file, "const instr_def_t *xlen_variant(const instr_def_t *def, int xlen);\n\n");
+    fprintf(file, "// Definition whose fixed bits match the word; pseudo-instructions\n");
+    fprintf(file, "// are never returned. Returns NULL for an unknown encoding.\n");
+    fprintf(file, "const instr_def_t *decode_instruction(uint32_t word);\n\n");
+    fprintf(file, "#endif // INSTR_TABLES_H\n");
+    fclose(file);
+}
+
+// "&rv32i_instructions[3]" followed by `suffix`
+static const char *def_ref(const instr_t *in, const char *suffix) {
+    static char ref[MAX_NAME * 2];
+    snprintf(ref, sizeof(ref), "&%s_instructions[%d]%s", extensions[in->ext].table, in->index, suffix);
+    return ref;
+}
+
+static int write_tables_source(const char *dir) {
+    FILE *file = open_output(dir, "instr_tables.c");
+    fprintf(file, "#include <string.h>\n\n#include \"instr_tables.h\"\n#include \"riscv_instructions.h\"\n\n");
+
+    /* ---- instr_def_t tables ---- */
+    fprintf(file, "/* ---------------------- Instruction tables ---------------------- */\n");
+    for (int e = 0; e < num_extensions; e++) {
+        const extension_t *ext = &extensions[e];
+        if (!ext->table[0]) continue;
+
+        int count = 0;
+        fprintf(file, "instr_def_t %s_instructions[] = {\n", ext->table);
+        for (int i = 0; i < num_instrs; i++) {
+            instr_t *in = &instrs[i];
+            if (in->ext != e) continue;
+            in->index = count++;
+
+            const syntax_info_t *info = &syntax_info[in->syntax];
+            int has_funct3  = (in->mask & 0x7000) == 0x7000;
+            int has_funct12 = in->syntax == SYN_R1 || in->syntax == SYN_SYSTEM || in->syntax == SYN_COUNTER;
+            int has_funct7  = in->syntax == SYN_R || in->syntax == SYN_R1 || in->syntax == SYN_I7;
+            int name_pad = 10 - (int)strlen(in->mnemonic);
+            int format_pad = 7 - (int)strlen(info->format);
+
+            fprintf(file, "    {\"%s\",%*s %s,%*s 0x%02X, 0x%X, 0x%02X, 0x%03X, %s, %2d, %d, %3d, %s, %s},%s\n",
+                    in->mnemonic, name_pad > 0 ? name_pad : 0, "",
+                    info->format, format_pad > 0 ? format_pad : 0, "",
+                    in->match & 0x7F,
+                    has_funct3 ? (in->match >> 12) & 0x7 : 0,
+                    has_funct7 ? (in->match >> 25) & 0x7F : 0,
+                    has_funct12 ? (in->match >> 20) & 0xFFF : 0,
+                    ext->enum_name, in->xlen, in->shamt_bits, i, info->encoder, info->parser,
+                    in->pseudo ? " // pseudo" : "");
+        }
+        fprintf(file, "};\n");
+        fprintf(file, "size_t num_%s_instructions = sizeof(%s_instructions) / sizeof(%s_instructions[0]);\n\n",
+                ext->table, ext->table, ext->table);
+    }
+
+    /* ---- Perfect-hash mnemonic index ---- */
+    int num_slots = 1, num_buckets, num_keys = 0;
+    for (int i = 0; i < num_instrs; i++)
+        num_keys += is_hashed(&instrs[i]);
+    while (num_slots < num_keys * 2) num_slots *= 2;
+    num_buckets = num_slots / 2;
+
+    uint16_t *seeds = malloc(num_buckets * sizeof(*seeds));
+    int *slots = malloc(num_slots * sizeof(*slots));
+    if (!seeds || !slots || !build_perfect_hash(num_buckets, num_slots, seeds, slots)) {
+        fprintf(stderr, "Cannot build the perfect hash\n");
+        return 0;
+    }
+
+    fprintf(file, "/* ---------------------- Mnemonic index ---------------------- */\n");
+    fprintf(file, "#define MNEMONIC_BUCKETS %d\n#define MNEMONIC_SLOTS %d\n\n", num_buckets, num_slots);
+    fprintf(file, "// Per-bucket seed that places every mnemonic of the bucket in its own slot\n");
+    fprintf(file, "static const uint16_t mnemonic_seeds[MNEMONIC_BUCKETS] = {");
+    for (int b = 0; b < num_buckets; b++)
+        fprintf(file, "%s%5u,", (b % 12) ? "" : "\n   ", seeds[b]);
+    fprintf(file, "\n};\n\n");
+
+    fprintf(file, "static instr_def_t *const mnemonic_slots[MNEMONIC_SLOTS] = {\n");
+    for (int s = 0; s < num_slots; s++) {
+        if (slots[s] < 0) continue;
+        fprintf(file, "    [%3d] = %-28s // %s\n", s, def_ref(&instrs[slots[s]], ","), instrs[slots[s]].mnemonic);
+    }
+    fprintf(file, "};\n\n");
+
+    fprintf(file,
+        "static uint32_t mnemonic_hash(uint32_t seed, const char *s) {\n"
+        "    uint32_t h = 2166136261u ^ seed;   // FNV-1a\n"
+        "    while (*s) {\n"
+        "        h ^= (unsigned char)*s++;\n"
+        "        h *= 16777619u;\n"
+        "    }\n"
+        "    return h;\n"
+        "}\n\n"
+        "instr_def_t *lookup_mnemonic(const char *mnemonic) {\n"
+        "    uint32_t bucket = mnemonic_hash(0, mnemonic) & (MNEMONIC_BUCKETS - 1);\n"
+        "    uint32_t slot = mnemonic_hash(mnemonic_seeds[bucket], mnemonic) & (MNEMONIC_SLOTS - 1);\n"
+        "    instr_def_t *def = mnemonic_slots[slot];\n"
+        "    return (def && strcmp(def->mnemonic, mnemonic) == 0) ? def : NULL;\n"
+        "}\n\n");
+    free(seeds);
+    free(slots);
+
+    /* ---- RV32/RV64 encodings of the same mnemonic ---- */
+    fprintf(file, "// {RV32, RV64} definitions of mnemonics whose encoding depends on XLEN\n");
+    fprintf(file, "static const instr_def_t *const xlen_variants[][2] = {\n");
+    for (int i = 0; i < num_instrs; i++) {
+        if (instrs[i].variant < 0 || instrs[i].xlen != 32) continue;
+        fprintf(file, "    {%s", def_ref(&instrs[i], ", "));
+        fprintf(file, "%s // %s\n", def_ref(&instrs[instrs[i].variant], "},"), instrs[i].mnemonic);
+    }
+    fprintf(file, "    {NULL, NULL}\n};\n\n");
+
+    fprintf(file,
+        "const instr_def_t *xlen_variant(const instr_def_t *def, int xlen) {\n"
+        "    if (def->xlen == 0 || def->xlen == xlen)\n"
+        "        return def;\n"
+        "    for (int i = 0; xlen_variants[i][0]; i++)\n"
+        "        if (xlen_variants[i][0] == def || xlen_variants[i][1] == def)\n"
+        "            return xlen_variants[i][xlen == 64];\n"
+        "    return NULL;\n"
+        "}\n\n");
+
+    /* ---- Mask/match decode table, grouped by major opcode ---- */
+    int first[128], count[128], total = 0;
+    fprintf(file, "/* ---------------------- Decode table ---------------------- */\n");
+    fprintf(file, "typedef struct {\n    uint32_t mask;\n    uint32_t match;\n    const instr_def_t *def;\n} decode_entry_t;\n\n");
+    fprintf(file, "// Most specific encodings first within each opcode\n");
+    fprintf(file, "static const decode_entry_t decode_table[] = {\n");
+    for (int op = 0; op < 128; op++) {
+        first[op] = total;
+        count[op] = 0;
+        for (int bits = 32; bits >= 0; bits--) {
+            for (int i = 0; i < num_instrs; i++) {
+                const instr_t *in = &instrs[i];
+                if (in->pseudo || (int)(in->match & 0x7F) != op || popcount(in->mask) != bits)
+                    continue;
+                fprintf(file, "    {0x%08X, 0x%08X, %-28s // %s\n", in->mask, in->match, def_ref(in, "},"), in->mnemonic);
+                count[op]++;
+                total++;
+            }
+        }
+    }
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "// Range of decode_table entries for each major opcode (bits 6..0)\n");
+    fprintf(file, "static const struct {\n    uint16_t first;\n    uint16_t count;\n} decode_index[128] = {\n");
+    for (int op = 0; op < 128; op++)
+        if (count[op])
+            fprintf(file, "    [0x%02X] = {%3d, %2d},\n", op, first[op], count[op]);
+    fprintf(file, "};\n\n");
+
+    fprintf(file,
+        "const instr_def_t *decode_instruction(uint32_t word) {\n"
+        "    const decode_entry_t *entry = &decode_table[decode_index[word & 0x7F].first];\n"
+        "    for (int n = decode_index[word & 0x7F].count; n > 0; n--, entry++)\n"
+        "        if ((word & entry->mask) == entry->match)\n"
+        "            return entry->def;\n"
+        "    return NULL;\n"
+        "}\n");
+    fclose(file);
+    return 1;
+}
+
+/* ---------------------- Main ---------------------- */
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        printf("Usage: %s <opcodes dir> <output dir>\n", argv[0]);
+        return 1;
+    }
+
+    read_manifest(argv[1]);
+    for (int e = 0; e < num_extensions; e++)
+        for (int f = 0; f < extensions[e].num_files; f++)
+            read_opcode_file(argv[1], e, extensions[e].files[f]);
+
+    write_extensions_header(argv[2]);
+    write_tables_header(argv[2]);
+    if (!write_tables_source(argv[2]))
+        return 1;
+
+    printf("Generated %d instructions in %d extensions\n", num_instrs, num_extensions);
+    return 0;
+}
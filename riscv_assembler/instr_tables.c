@@ -0,0 +1,486 @@
+// instr_tables.c
+// Generated by gen_tables from opcodes/. Do not edit.
+#include <string.h>
+
+#include "instr_tables.h"
+#include "riscv_instructions.h"
+
+/* ---------------------- Instruction tables ---------------------- */
+instr_def_t rv32i_instructions[] = {
+    {"add",        TYPE_R,  0x33, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,   0, encode_r_type, parse_r_type},
+    {"sub",        TYPE_R,  0x33, 0x0, 0x20, 0x000, ISA_RV32I,  0, 0,   1, encode_r_type, parse_r_type},
+    {"sll",        TYPE_R,  0x33, 0x1, 0x00, 0x000, ISA_RV32I,  0, 0,   2, encode_r_type, parse_r_type},
+    {"slt",        TYPE_R,  0x33, 0x2, 0x00, 0x000, ISA_RV32I,  0, 0,   3, encode_r_type, parse_r_type},
+    {"sltu",       TYPE_R,  0x33, 0x3, 0x00, 0x000, ISA_RV32I,  0, 0,   4, encode_r_type, parse_r_type},
+    {"xor",        TYPE_R,  0x33, 0x4, 0x00, 0x000, ISA_RV32I,  0, 0,   5, encode_r_type, parse_r_type},
+    {"srl",        TYPE_R,  0x33, 0x5, 0x00, 0x000, ISA_RV32I,  0, 0,   6, encode_r_type, parse_r_type},
+    {"sra",        TYPE_R,  0x33, 0x5, 0x20, 0x000, ISA_RV32I,  0, 0,   7, encode_r_type, parse_r_type},
+    {"or",         TYPE_R,  0x33, 0x6, 0x00, 0x000, ISA_RV32I,  0, 0,   8, encode_r_type, parse_r_type},
+    {"and",        TYPE_R,  0x33, 0x7, 0x00, 0x000, ISA_RV32I,  0, 0,   9, encode_r_type, parse_r_type},
+    {"lb",         TYPE_I,  0x03, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  10, encode_i_type, parse_load},
+    {"lh",         TYPE_I,  0x03, 0x1, 0x00, 0x000, ISA_RV32I,  0, 0,  11, encode_i_type, parse_load},
+    {"lw",         TYPE_I,  0x03, 0x2, 0x00, 0x000, ISA_RV32I,  0, 0,  12, encode_i_type, parse_load},
+    {"lbu",        TYPE_I,  0x03, 0x4, 0x00, 0x000, ISA_RV32I,  0, 0,  13, encode_i_type, parse_load},
+    {"lhu",        TYPE_I,  0x03, 0x5, 0x00, 0x000, ISA_RV32I,  0, 0,  14, encode_i_type, parse_load},
+    {"addi",       TYPE_I,  0x13, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  15, encode_i_type, parse_i_type},
+    {"slti",       TYPE_I,  0x13, 0x2, 0x00, 0x000, ISA_RV32I,  0, 0,  16, encode_i_type, parse_i_type},
+    {"sltiu",      TYPE_I,  0x13, 0x3, 0x00, 0x000, ISA_RV32I,  0, 0,  17, encode_i_type, parse_i_type},
+    {"xori",       TYPE_I,  0x13, 0x4, 0x00, 0x000, ISA_RV32I,  0, 0,  18, encode_i_type, parse_i_type},
+    {"ori",        TYPE_I,  0x13, 0x6, 0x00, 0x000, ISA_RV32I,  0, 0,  19, encode_i_type, parse_i_type},
+    {"andi",       TYPE_I,  0x13, 0x7, 0x00, 0x000, ISA_RV32I,  0, 0,  20, encode_i_type, parse_i_type},
+    {"jalr",       TYPE_I,  0x67, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  21, encode_i_type, parse_i_type},
+    {"slli",       TYPE_I7, 0x13, 0x1, 0x00, 0x000, ISA_RV32I,  0, 6,  22, encode_i7_type, parse_i7_type},
+    {"srli",       TYPE_I7, 0x13, 0x5, 0x00, 0x000, ISA_RV32I,  0, 6,  23, encode_i7_type, parse_i7_type},
+    {"srai",       TYPE_I7, 0x13, 0x5, 0x20, 0x000, ISA_RV32I,  0, 6,  24, encode_i7_type, parse_i7_type},
+    {"sb",         TYPE_S,  0x23, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  25, encode_s_type, parse_s_type},
+    {"sh",         TYPE_S,  0x23, 0x1, 0x00, 0x000, ISA_RV32I,  0, 0,  26, encode_s_type, parse_s_type},
+    {"sw",         TYPE_S,  0x23, 0x2, 0x00, 0x000, ISA_RV32I,  0, 0,  27, encode_s_type, parse_s_type},
+    {"beq",        TYPE_B,  0x63, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  28, encode_b_type, parse_b_type},
+    {"bne",        TYPE_B,  0x63, 0x1, 0x00, 0x000, ISA_RV32I,  0, 0,  29, encode_b_type, parse_b_type},
+    {"blt",        TYPE_B,  0x63, 0x4, 0x00, 0x000, ISA_RV32I,  0, 0,  30, encode_b_type, parse_b_type},
+    {"bge",        TYPE_B,  0x63, 0x5, 0x00, 0x000, ISA_RV32I,  0, 0,  31, encode_b_type, parse_b_type},
+    {"bltu",       TYPE_B,  0x63, 0x6, 0x00, 0x000, ISA_RV32I,  0, 0,  32, encode_b_type, parse_b_type},
+    {"bgeu",       TYPE_B,  0x63, 0x7, 0x00, 0x000, ISA_RV32I,  0, 0,  33, encode_b_type, parse_b_type},
+    {"lui",        TYPE_U,  0x37, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  34, encode_u_type, parse_u_type},
+    {"auipc",      TYPE_U,  0x17, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  35, encode_u_type, parse_u_type},
+    {"jal",        TYPE_J,  0x6F, 0x0, 0x00, 0x000, ISA_RV32I,  0, 0,  36, encode_j_type, parse_j_type},
+};
+size_t num_rv32i_instructions = sizeof(rv32i_instructions) / sizeof(rv32i_instructions[0]);
+
+instr_def_t rv64i_instructions[] = {
+    {"ld",         TYPE_I,  0x03, 0x3, 0x00, 0x000, ISA_RV64I, 64, 0,  37, encode_i_type, parse_load},
+    {"lwu",        TYPE_I,  0x03, 0x6, 0x00, 0x000, ISA_RV64I, 64, 0,  38, encode_i_type, parse_load},
+    {"addiw",      TYPE_I,  0x1B, 0x0, 0x00, 0x000, ISA_RV64I, 64, 0,  39, encode_i_type, parse_i_type},
+    {"slliw",      TYPE_I7, 0x1B, 0x1, 0x00, 0x000, ISA_RV64I, 64, 5,  40, encode_i7_type, parse_i7_type},
+    {"srliw",      TYPE_I7, 0x1B, 0x5, 0x00, 0x000, ISA_RV64I, 64, 5,  41, encode_i7_type, parse_i7_type},
+    {"sraiw",      TYPE_I7, 0x1B, 0x5, 0x20, 0x000, ISA_RV64I, 64, 5,  42, encode_i7_type, parse_i7_type},
+    {"sd",         TYPE_S,  0x23, 0x3, 0x00, 0x000, ISA_RV64I, 64, 0,  43, encode_s_type, parse_s_type},
+    {"addw",       TYPE_R,  0x3B, 0x0, 0x00, 0x000, ISA_RV64I, 64, 0,  44, encode_r_type, parse_r_type},
+    {"subw",       TYPE_R,  0x3B, 0x0, 0x20, 0x000, ISA_RV64I, 64, 0,  45, encode_r_type, parse_r_type},
+    {"sllw",       TYPE_R,  0x3B, 0x1, 0x00, 0x000, ISA_RV64I, 64, 0,  46, encode_r_type, parse_r_type},
+    {"srlw",       TYPE_R,  0x3B, 0x5, 0x00, 0x000, ISA_RV64I, 64, 0,  47, encode_r_type, parse_r_type},
+    {"sraw",       TYPE_R,  0x3B, 0x5, 0x20, 0x000, ISA_RV64I, 64, 0,  48, encode_r_type, parse_r_type},
+};
+size_t num_rv64i_instructions = sizeof(rv64i_instructions) / sizeof(rv64i_instructions[0]);
+
+instr_def_t zicsr_instructions[] = {
+    {"ecall",      TYPE_I,  0x73, 0x0, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  49, encode_i_type, parse_system},
+    {"ebreak",     TYPE_I,  0x73, 0x0, 0x00, 0x001, ISA_EXT_ZICSR,  0, 0,  50, encode_i_type, parse_system},
+    {"mret",       TYPE_I,  0x73, 0x0, 0x00, 0x302, ISA_EXT_ZICSR,  0, 0,  51, encode_i_type, parse_system},
+    {"csrrw",      TYPE_I,  0x73, 0x1, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  52, encode_i_type, parse_csr_reg},
+    {"csrrs",      TYPE_I,  0x73, 0x2, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  53, encode_i_type, parse_csr_reg},
+    {"csrrc",      TYPE_I,  0x73, 0x3, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  54, encode_i_type, parse_csr_reg},
+    {"csrrwi",     TYPE_I,  0x73, 0x5, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  55, encode_i_type, parse_csr_imm},
+    {"csrrsi",     TYPE_I,  0x73, 0x6, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  56, encode_i_type, parse_csr_imm},
+    {"csrrci",     TYPE_I,  0x73, 0x7, 0x00, 0x000, ISA_EXT_ZICSR,  0, 0,  57, encode_i_type, parse_csr_imm},
+    {"rdcycle",    TYPE_I,  0x73, 0x2, 0x00, 0xC00, ISA_EXT_ZICSR,  0, 0,  58, encode_i_type, parse_counter}, // pseudo
+    {"rdtime",     TYPE_I,  0x73, 0x2, 0x00, 0xC01, ISA_EXT_ZICSR,  0, 0,  59, encode_i_type, parse_counter}, // pseudo
+    {"rdinstret",  TYPE_I,  0x73, 0x2, 0x00, 0xC02, ISA_EXT_ZICSR,  0, 0,  60, encode_i_type, parse_counter}, // pseudo
+    {"rdcycleh",   TYPE_I,  0x73, 0x2, 0x00, 0xC80, ISA_EXT_ZICSR, 32, 0,  61, encode_i_type, parse_counter}, // pseudo
+    {"rdtimeh",    TYPE_I,  0x73, 0x2, 0x00, 0xC81, ISA_EXT_ZICSR, 32, 0,  62, encode_i_type, parse_counter}, // pseudo
+    {"rdinstreth", TYPE_I,  0x73, 0x2, 0x00, 0xC82, ISA_EXT_ZICSR, 32, 0,  63, encode_i_type, parse_counter}, // pseudo
+};
+size_t num_zicsr_instructions = sizeof(zicsr_instructions) / sizeof(zicsr_instructions[0]);
+
+instr_def_t m_instructions[] = {
+    {"mul",        TYPE_R,  0x33, 0x0, 0x01, 0x000, ISA_EXT_M,  0, 0,  64, encode_r_type, parse_r_type},
+    {"mulh",       TYPE_R,  0x33, 0x1, 0x01, 0x000, ISA_EXT_M,  0, 0,  65, encode_r_type, parse_r_type},
+    {"mulhsu",     TYPE_R,  0x33, 0x2, 0x01, 0x000, ISA_EXT_M,  0, 0,  66, encode_r_type, parse_r_type},
+    {"mulhu",      TYPE_R,  0x33, 0x3, 0x01, 0x000, ISA_EXT_M,  0, 0,  67, encode_r_type, parse_r_type},
+    {"div",        TYPE_R,  0x33, 0x4, 0x01, 0x000, ISA_EXT_M,  0, 0,  68, encode_r_type, parse_r_type},
+    {"divu",       TYPE_R,  0x33, 0x5, 0x01, 0x000, ISA_EXT_M,  0, 0,  69, encode_r_type, parse_r_type},
+    {"rem",        TYPE_R,  0x33, 0x6, 0x01, 0x000, ISA_EXT_M,  0, 0,  70, encode_r_type, parse_r_type},
+    {"remu",       TYPE_R,  0x33, 0x7, 0x01, 0x000, ISA_EXT_M,  0, 0,  71, encode_r_type, parse_r_type},
+    {"mulw",       TYPE_R,  0x3B, 0x0, 0x01, 0x000, ISA_EXT_M, 64, 0,  72, encode_r_type, parse_r_type},
+    {"divw",       TYPE_R,  0x3B, 0x4, 0x01, 0x000, ISA_EXT_M, 64, 0,  73, encode_r_type, parse_r_type},
+    {"divuw",      TYPE_R,  0x3B, 0x5, 0x01, 0x000, ISA_EXT_M, 64, 0,  74, encode_r_type, parse_r_type},
+    {"remw",       TYPE_R,  0x3B, 0x6, 0x01, 0x000, ISA_EXT_M, 64, 0,  75, encode_r_type, parse_r_type},
+    {"remuw",      TYPE_R,  0x3B, 0x7, 0x01, 0x000, ISA_EXT_M, 64, 0,  76, encode_r_type, parse_r_type},
+};
+size_t num_m_instructions = sizeof(m_instructions) / sizeof(m_instructions[0]);
+
+instr_def_t zba_instructions[] = {
+    {"sh1add",     TYPE_R,  0x33, 0x2, 0x10, 0x000, ISA_EXT_ZBA,  0, 0,  77, encode_r_type, parse_r_type},
+    {"sh2add",     TYPE_R,  0x33, 0x4, 0x10, 0x000, ISA_EXT_ZBA,  0, 0,  78, encode_r_type, parse_r_type},
+    {"sh3add",     TYPE_R,  0x33, 0x6, 0x10, 0x000, ISA_EXT_ZBA,  0, 0,  79, encode_r_type, parse_r_type},
+    {"add.uw",     TYPE_R,  0x3B, 0x0, 0x04, 0x000, ISA_EXT_ZBA, 64, 0,  80, encode_r_type, parse_r_type},
+    {"sh1add.uw",  TYPE_R,  0x3B, 0x2, 0x10, 0x000, ISA_EXT_ZBA, 64, 0,  81, encode_r_type, parse_r_type},
+    {"sh2add.uw",  TYPE_R,  0x3B, 0x4, 0x10, 0x000, ISA_EXT_ZBA, 64, 0,  82, encode_r_type, parse_r_type},
+    {"sh3add.uw",  TYPE_R,  0x3B, 0x6, 0x10, 0x000, ISA_EXT_ZBA, 64, 0,  83, encode_r_type, parse_r_type},
+    {"slli.uw",    TYPE_I7, 0x1B, 0x1, 0x04, 0x000, ISA_EXT_ZBA, 64, 6,  84, encode_i7_type, parse_i7_type},
+};
+size_t num_zba_instructions = sizeof(zba_instructions) / sizeof(zba_instructions[0]);
+
+instr_def_t zbb_instructions[] = {
+    {"andn",       TYPE_R,  0x33, 0x7, 0x20, 0x000, ISA_EXT_ZBB,  0, 0,  85, encode_r_type, parse_r_type},
+    {"orn",        TYPE_R,  0x33, 0x6, 0x20, 0x000, ISA_EXT_ZBB,  0, 0,  86, encode_r_type, parse_r_type},
+    {"xnor",       TYPE_R,  0x33, 0x4, 0x20, 0x000, ISA_EXT_ZBB,  0, 0,  87, encode_r_type, parse_r_type},
+    {"min",        TYPE_R,  0x33, 0x4, 0x05, 0x000, ISA_EXT_ZBB,  0, 0,  88, encode_r_type, parse_r_type},
+    {"minu",       TYPE_R,  0x33, 0x5, 0x05, 0x000, ISA_EXT_ZBB,  0, 0,  89, encode_r_type, parse_r_type},
+    {"max",        TYPE_R,  0x33, 0x6, 0x05, 0x000, ISA_EXT_ZBB,  0, 0,  90, encode_r_type, parse_r_type},
+    {"maxu",       TYPE_R,  0x33, 0x7, 0x05, 0x000, ISA_EXT_ZBB,  0, 0,  91, encode_r_type, parse_r_type},
+    {"rol",        TYPE_R,  0x33, 0x1, 0x30, 0x000, ISA_EXT_ZBB,  0, 0,  92, encode_r_type, parse_r_type},
+    {"ror",        TYPE_R,  0x33, 0x5, 0x30, 0x000, ISA_EXT_ZBB,  0, 0,  93, encode_r_type, parse_r_type},
+    {"rori",       TYPE_I7, 0x13, 0x5, 0x30, 0x000, ISA_EXT_ZBB,  0, 6,  94, encode_i7_type, parse_i7_type},
+    {"clz",        TYPE_R,  0x13, 0x1, 0x30, 0x600, ISA_EXT_ZBB,  0, 0,  95, encode_r1_type, parse_r1_type},
+    {"ctz",        TYPE_R,  0x13, 0x1, 0x30, 0x601, ISA_EXT_ZBB,  0, 0,  96, encode_r1_type, parse_r1_type},
+    {"cpop",       TYPE_R,  0x13, 0x1, 0x30, 0x602, ISA_EXT_ZBB,  0, 0,  97, encode_r1_type, parse_r1_type},
+    {"sext.b",     TYPE_R,  0x13, 0x1, 0x30, 0x604, ISA_EXT_ZBB,  0, 0,  98, encode_r1_type, parse_r1_type},
+    {"sext.h",     TYPE_R,  0x13, 0x1, 0x30, 0x605, ISA_EXT_ZBB,  0, 0,  99, encode_r1_type, parse_r1_type},
+    {"orc.b",      TYPE_R,  0x13, 0x5, 0x14, 0x287, ISA_EXT_ZBB,  0, 0, 100, encode_r1_type, parse_r1_type},
+    {"rev8",       TYPE_R,  0x13, 0x5, 0x34, 0x698, ISA_EXT_ZBB, 32, 0, 101, encode_r1_type, parse_r1_type},
+    {"zext.h",     TYPE_R,  0x33, 0x4, 0x04, 0x080, ISA_EXT_ZBB, 32, 0, 102, encode_r1_type, parse_r1_type},
+    {"rev8",       TYPE_R,  0x13, 0x5, 0x35, 0x6B8, ISA_EXT_ZBB, 64, 0, 103, encode_r1_type, parse_r1_type},
+    {"zext.h",     TYPE_R,  0x3B, 0x4, 0x04, 0x080, ISA_EXT_ZBB, 64, 0, 104, encode_r1_type, parse_r1_type},
+    {"clzw",       TYPE_R,  0x1B, 0x1, 0x30, 0x600, ISA_EXT_ZBB, 64, 0, 105, encode_r1_type, parse_r1_type},
+    {"ctzw",       TYPE_R,  0x1B, 0x1, 0x30, 0x601, ISA_EXT_ZBB, 64, 0, 106, encode_r1_type, parse_r1_type},
+    {"cpopw",      TYPE_R,  0x1B, 0x1, 0x30, 0x602, ISA_EXT_ZBB, 64, 0, 107, encode_r1_type, parse_r1_type},
+    {"rolw",       TYPE_R,  0x3B, 0x1, 0x30, 0x000, ISA_EXT_ZBB, 64, 0, 108, encode_r_type, parse_r_type},
+    {"rorw",       TYPE_R,  0x3B, 0x5, 0x30, 0x000, ISA_EXT_ZBB, 64, 0, 109, encode_r_type, parse_r_type},
+    {"roriw",      TYPE_I7, 0x1B, 0x5, 0x30, 0x000, ISA_EXT_ZBB, 64, 5, 110, encode_i7_type, parse_i7_type},
+};
+size_t num_zbb_instructions = sizeof(zbb_instructions) / sizeof(zbb_instructions[0]);
+
+instr_def_t zbs_instructions[] = {
+    {"bclr",       TYPE_R,  0x33, 0x1, 0x24, 0x000, ISA_EXT_ZBS,  0, 0, 111, encode_r_type, parse_r_type},
+    {"bext",       TYPE_R,  0x33, 0x5, 0x24, 0x000, ISA_EXT_ZBS,  0, 0, 112, encode_r_type, parse_r_type},
+    {"binv",       TYPE_R,  0x33, 0x1, 0x34, 0x000, ISA_EXT_ZBS,  0, 0, 113, encode_r_type, parse_r_type},
+    {"bset",       TYPE_R,  0x33, 0x1, 0x14, 0x000, ISA_EXT_ZBS,  0, 0, 114, encode_r_type, parse_r_type},
+    {"bclri",      TYPE_I7, 0x13, 0x1, 0x24, 0x000, ISA_EXT_ZBS,  0, 6, 115, encode_i7_type, parse_i7_type},
+    {"bexti",      TYPE_I7, 0x13, 0x5, 0x24, 0x000, ISA_EXT_ZBS,  0, 6, 116, encode_i7_type, parse_i7_type},
+    {"binvi",      TYPE_I7, 0x13, 0x1, 0x34, 0x000, ISA_EXT_ZBS,  0, 6, 117, encode_i7_type, parse_i7_type},
+    {"bseti",      TYPE_I7, 0x13, 0x1, 0x14, 0x000, ISA_EXT_ZBS,  0, 6, 118, encode_i7_type, parse_i7_type},
+};
+size_t num_zbs_instructions = sizeof(zbs_instructions) / sizeof(zbs_instructions[0]);
+
+instr_def_t zicond_instructions[] = {
+    {"czero.eqz",  TYPE_R,  0x33, 0x5, 0x07, 0x000, ISA_EXT_ZICOND,  0, 0, 119, encode_r_type, parse_r_type},
+    {"czero.nez",  TYPE_R,  0x33, 0x7, 0x07, 0x000, ISA_EXT_ZICOND,  0, 0, 120, encode_r_type, parse_r_type},
+};
+size_t num_zicond_instructions = sizeof(zicond_instructions) / sizeof(zicond_instructions[0]);
+
+/* ---------------------- Mnemonic index ---------------------- */
+#define MNEMONIC_BUCKETS 128
+#define MNEMONIC_SLOTS 256
+
+// Per-bucket seed that places every mnemonic of the bucket in its own slot
+static const uint16_t mnemonic_seeds[MNEMONIC_BUCKETS] = {
+       1,    1,    1,    0,    1,    0,    1,    4,    0,    0,    1,    1,
+       4,    1,    1,    0,    0,    0,    2,    1,    1,    2,    0,    1,
+       0,    1,    1,    0,    6,    1,    0,    2,    2,    0,    1,    1,
+       0,    0,    1,    2,    0,    0,    0,    2,    0,    1,    0,    1,
+       1,    0,    2,    0,    2,    1,    0,    0,    0,    1,    1,    0,
+       1,    1,    0,    0,    1,    1,    2,    1,    1,    0,    2,    1,
+       1,    1,    0,    2,    0,    0,    0,    0,    1,    0,    0,    3,
+       0,    0,    1,    1,    1,    2,    1,    1,    2,    1,    1,    0,
+       0,    1,    0,    1,    1,    2,    0,    2,    1,    1,    0,    3,
+       0,    0,    2,    2,    1,    0,    0,    0,    1,    1,    1,    0,
+       1,    1,    1,    0,    0,    2,    1,    1,
+};
+
+static instr_def_t *const mnemonic_slots[MNEMONIC_SLOTS] = {
+    [  0] = &zicond_instructions[1],     // czero.nez
+    [  1] = &rv32i_instructions[13],     // lbu
+    [  2] = &m_instructions[0],          // mul
+    [  3] = &rv64i_instructions[4],      // srliw
+    [  5] = &zbb_instructions[22],       // cpopw
+    [  9] = &rv32i_instructions[5],      // xor
+    [ 10] = &zba_instructions[1],        // sh2add
+    [ 11] = &m_instructions[6],          // rem
+    [ 12] = &rv32i_instructions[7],      // sra
+    [ 13] = &rv32i_instructions[32],     // bltu
+    [ 16] = &zbs_instructions[5],        // bexti
+    [ 17] = &zbb_instructions[0],        // andn
+    [ 20] = &rv64i_instructions[0],      // ld
+    [ 23] = &zba_instructions[6],        // sh3add.uw
+    [ 24] = &zbb_instructions[24],       // rorw
+    [ 26] = &rv64i_instructions[1],      // lwu
+    [ 27] = &rv32i_instructions[11],     // lh
+    [ 28] = &rv32i_instructions[16],     // slti
+    [ 31] = &zicsr_instructions[5],      // csrrc
+    [ 32] = &rv32i_instructions[18],     // xori
+    [ 33] = &rv32i_instructions[15],     // addi
+    [ 36] = &zbb_instructions[21],       // ctzw
+    [ 37] = &rv32i_instructions[9],      // and
+    [ 40] = &rv64i_instructions[6],      // sd
+    [ 45] = &zicond_instructions[0],     // czero.eqz
+    [ 47] = &zba_instructions[3],        // add.uw
+    [ 48] = &rv32i_instructions[19],     // ori
+    [ 49] = &m_instructions[3],          // mulhu
+    [ 50] = &rv32i_instructions[12],     // lw
+    [ 51] = &zbb_instructions[2],        // xnor
+    [ 52] = &rv32i_instructions[35],     // auipc
+    [ 53] = &zbb_instructions[1],        // orn
+    [ 55] = &zba_instructions[7],        // slli.uw
+    [ 56] = &rv32i_instructions[4],      // sltu
+    [ 58] = &rv32i_instructions[34],     // lui
+    [ 70] = &rv32i_instructions[27],     // sw
+    [ 71] = &zba_instructions[2],        // sh3add
+    [ 75] = &rv32i_instructions[17],     // sltiu
+    [ 77] = &zbb_instructions[9],        // rori
+    [ 78] = &zba_instructions[0],        // sh1add
+    [ 79] = &zicsr_instructions[4],      // csrrs
+    [ 81] = &zbs_instructions[7],        // bseti
+    [ 82] = &zbb_instructions[5],        // max
+    [ 87] = &m_instructions[7],          // remu
+    [ 93] = &m_instructions[1],          // mulh
+    [ 96] = &m_instructions[12],         // remuw
+    [ 97] = &zicsr_instructions[13],     // rdtimeh
+    [ 98] = &zbs_instructions[3],        // bset
+    [101] = &zbb_instructions[6],        // maxu
+    [112] = &zbb_instructions[12],       // cpop
+    [113] = &zbs_instructions[2],        // binv
+    [115] = &m_instructions[10],         // divuw
+    [121] = &rv32i_instructions[8],      // or
+    [125] = &m_instructions[11],         // remw
+    [129] = &rv32i_instructions[23],     // srli
+    [131] = &zicsr_instructions[0],      // ecall
+    [132] = &zbb_instructions[7],        // rol
+    [134] = &zbb_instructions[15],       // orc.b
+    [135] = &rv32i_instructions[36],     // jal
+    [136] = &rv32i_instructions[21],     // jalr
+    [137] = &zicsr_instructions[11],     // rdinstret
+    [141] = &rv64i_instructions[5],      // sraiw
+    [143] = &rv64i_instructions[2],      // addiw
+    [145] = &rv32i_instructions[33],     // bgeu
+    [146] = &rv32i_instructions[29],     // bne
+    [148] = &rv64i_instructions[10],     // srlw
+    [153] = &rv64i_instructions[3],      // slliw
+    [154] = &rv32i_instructions[25],     // sb
+    [156] = &zbb_instructions[20],       // clzw
+    [157] = &rv32i_instructions[3],      // slt
+    [159] = &rv32i_instructions[14],     // lhu
+    [161] = &rv64i_instructions[11],     // sraw
+    [162] = &zbb_instructions[14],       // sext.h
+    [164] = &rv32i_instructions[20],     // andi
+    [169] = &rv32i_instructions[10],     // lb
+    [170] = &rv32i_instructions[30],     // blt
+    [171] = &m_instructions[5],          // divu
+    [172] = &zicsr_instructions[14],     // rdinstreth
+    [175] = &zbb_instructions[17],       // zext.h
+    [176] = &m_instructions[9],          // divw
+    [180] = &rv32i_instructions[2],      // sll
+    [182] = &zicsr_instructions[9],      // rdcycle
+    [187] = &zbb_instructions[11],       // ctz
+    [190] = &rv32i_instructions[31],     // bge
+    [191] = &rv32i_instructions[0],      // add
+    [194] = &zicsr_instructions[8],      // csrrci
+    [195] = &zbb_instructions[16],       // rev8
+    [197] = &zicsr_instructions[2],      // mret
+    [199] = &rv32i_instructions[26],     // sh
+    [200] = &zbs_instructions[6],        // binvi
+    [203] = &rv32i_instructions[1],      // sub
+    [204] = &zicsr_instructions[12],     // rdcycleh
+    [205] = &m_instructions[2],          // mulhsu
+    [206] = &zbb_instructions[10],       // clz
+    [207] = &zbb_instructions[25],       // roriw
+    [210] = &zicsr_instructions[7],      // csrrsi
+    [211] = &zicsr_instructions[10],     // rdtime
+    [212] = &rv32i_instructions[22],     // slli
+    [216] = &rv64i_instructions[7],      // addw
+    [217] = &zbs_instructions[1],        // bext
+    [222] = &zicsr_instructions[6],      // csrrwi
+    [226] = &zbb_instructions[23],       // rolw
+    [230] = &zicsr_instructions[1],      // ebreak
+    [231] = &m_instructions[4],          // div
+    [232] = &zicsr_instructions[3],      // csrrw
+    [235] = &rv32i_instructions[6],      // srl
+    [236] = &rv32i_instructions[28],     // beq
+    [237] = &zba_instructions[5],        // sh2add.uw
+    [240] = &m_instructions[8],          // mulw
+    [244] = &rv64i_instructions[8],      // subw
+    [245] = &zba_instructions[4],        // sh1add.uw
+    [246] = &zbb_instructions[8],        // ror
+    [247] = &zbb_instructions[4],        // minu
+    [248] = &zbb_instructions[3],        // min
+    [249] = &rv64i_instructions[9],      // sllw
+    [251] = &zbb_instructions[13],       // sext.b
+    [252] = &zbs_instructions[4],        // bclri
+    [253] = &zbs_instructions[0],        // bclr
+    [255] = &rv32i_instructions[24],     // srai
+};
+
+static uint32_t mnemonic_hash(uint32_t seed, const char *s) {
+    uint32_t h = 2166136261u ^ seed;   // FNV-1a
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+instr_def_t *lookup_mnemonic(const char *mnemonic) {
+    uint32_t bucket = mnemonic_hash(0, mnemonic) & (MNEMONIC_BUCKETS - 1);
+    uint32_t slot = mnemonic_hash(mnemonic_seeds[bucket], mnemonic) & (MNEMONIC_SLOTS - 1);
+    instr_def_t *def = mnemonic_slots[slot];
+    return (def && strcmp(def->mnemonic, mnemonic) == 0) ? def : NULL;
+}
+
+// {RV32, RV64} definitions of mnemonics whose encoding depends on XLEN
+static const instr_def_t *const xlen_variants[][2] = {
+    {&zbb_instructions[16], &zbb_instructions[18]}, // rev8
+    {&zbb_instructions[17], &zbb_instructions[19]}, // zext.h
+    {NULL, NULL}
+};
+
+const instr_def_t *xlen_variant(const instr_def_t *def, int xlen) {
+    if (def->xlen == 0 || def->xlen == xlen)
+        return def;
+    for (int i = 0; xlen_variants[i][0]; i++)
+        if (xlen_variants[i][0] == def || xlen_variants[i][1] == def)
+            return xlen_variants[i][xlen == 64];
+    return NULL;
+}
+
+/* ---------------------- Decode table ---------------------- */
+typedef struct {
+    uint32_t mask;
+    uint32_t match;
+    const instr_def_t *def;
+} decode_entry_t;
+
+// Most specific encodings first within each opcode
+static const decode_entry_t decode_table[] = {
+    {0x0000707F, 0x00000003, &rv32i_instructions[10]},    // lb
+    {0x0000707F, 0x00001003, &rv32i_instructions[11]},    // lh
+    {0x0000707F, 0x00002003, &rv32i_instructions[12]},    // lw
+    {0x0000707F, 0x00004003, &rv32i_instructions[13]},    // lbu
+    {0x0000707F, 0x00005003, &rv32i_instructions[14]},    // lhu
+    {0x0000707F, 0x00003003, &rv64i_instructions[0]},     // ld
+    {0x0000707F, 0x00006003, &rv64i_instructions[1]},     // lwu
+    {0xFFF0707F, 0x60001013, &zbb_instructions[10]},      // clz
+    {0xFFF0707F, 0x60101013, &zbb_instructions[11]},      // ctz
+    {0xFFF0707F, 0x60201013, &zbb_instructions[12]},      // cpop
+    {0xFFF0707F, 0x60401013, &zbb_instructions[13]},      // sext.b
+    {0xFFF0707F, 0x60501013, &zbb_instructions[14]},      // sext.h
+    {0xFFF0707F, 0x28705013, &zbb_instructions[15]},      // orc.b
+    {0xFFF0707F, 0x69805013, &zbb_instructions[16]},      // rev8
+    {0xFFF0707F, 0x6B805013, &zbb_instructions[18]},      // rev8
+    {0xFC00707F, 0x00001013, &rv32i_instructions[22]},    // slli
+    {0xFC00707F, 0x00005013, &rv32i_instructions[23]},    // srli
+    {0xFC00707F, 0x40005013, &rv32i_instructions[24]},    // srai
+    {0xFC00707F, 0x60005013, &zbb_instructions[9]},       // rori
+    {0xFC00707F, 0x48001013, &zbs_instructions[4]},       // bclri
+    {0xFC00707F, 0x48005013, &zbs_instructions[5]},       // bexti
+    {0xFC00707F, 0x68001013, &zbs_instructions[6]},       // binvi
+    {0xFC00707F, 0x28001013, &zbs_instructions[7]},       // bseti
+    {0x0000707F, 0x00000013, &rv32i_instructions[15]},    // addi
+    {0x0000707F, 0x00002013, &rv32i_instructions[16]},    // slti
+    {0x0000707F, 0x00003013, &rv32i_instructions[17]},    // sltiu
+    {0x0000707F, 0x00004013, &rv32i_instructions[18]},    // xori
+    {0x0000707F, 0x00006013, &rv32i_instructions[19]},    // ori
+    {0x0000707F, 0x00007013, &rv32i_instructions[20]},    // andi
+    {0x0000007F, 0x00000017, &rv32i_instructions[35]},    // auipc
+    {0xFFF0707F, 0x6000101B, &zbb_instructions[20]},      // clzw
+    {0xFFF0707F, 0x6010101B, &zbb_instructions[21]},      // ctzw
+    {0xFFF0707F, 0x6020101B, &zbb_instructions[22]},      // cpopw
+    {0xFE00707F, 0x0000101B, &rv64i_instructions[3]},     // slliw
+    {0xFE00707F, 0x0000501B, &rv64i_instructions[4]},     // srliw
+    {0xFE00707F, 0x4000501B, &rv64i_instructions[5]},     // sraiw
+    {0xFE00707F, 0x6000501B, &zbb_instructions[25]},      // roriw
+    {0xFC00707F, 0x0800101B, &zba_instructions[7]},       // slli.uw
+    {0x0000707F, 0x0000001B, &rv64i_instructions[2]},     // addiw
+    {0x0000707F, 0x00000023, &rv32i_instructions[25]},    // sb
+    {0x0000707F, 0x00001023, &rv32i_instructions[26]},    // sh
+    {0x0000707F, 0x00002023, &rv32i_instructions[27]},    // sw
+    {0x0000707F, 0x00003023, &rv64i_instructions[6]},     // sd
+    {0xFFF0707F, 0x08004033, &zbb_instructions[17]},      // zext.h
+    {0xFE00707F, 0x00000033, &rv32i_instructions[0]},     // add
+    {0xFE00707F, 0x40000033, &rv32i_instructions[1]},     // sub
+    {0xFE00707F, 0x00001033, &rv32i_instructions[2]},     // sll
+    {0xFE00707F, 0x00002033, &rv32i_instructions[3]},     // slt
+    {0xFE00707F, 0x00003033, &rv32i_instructions[4]},     // sltu
+    {0xFE00707F, 0x00004033, &rv32i_instructions[5]},     // xor
+    {0xFE00707F, 0x00005033, &rv32i_instructions[6]},     // srl
+    {0xFE00707F, 0x40005033, &rv32i_instructions[7]},     // sra
+    {0xFE00707F, 0x00006033, &rv32i_instructions[8]},     // or
+    {0xFE00707F, 0x00007033, &rv32i_instructions[9]},     // and
+    {0xFE00707F, 0x02000033, &m_instructions[0]},         // mul
+    {0xFE00707F, 0x02001033, &m_instructions[1]},         // mulh
+    {0xFE00707F, 0x02002033, &m_instructions[2]},         // mulhsu
+    {0xFE00707F, 0x02003033, &m_instructions[3]},         // mulhu
+    {0xFE00707F, 0x02004033, &m_instructions[4]},         // div
+    {0xFE00707F, 0x02005033, &m_instructions[5]},         // divu
+    {0xFE00707F, 0x02006033, &m_instructions[6]},         // rem
+    {0xFE00707F, 0x02007033, &m_instructions[7]},         // remu
+    {0xFE00707F, 0x20002033, &zba_instructions[0]},       // sh1add
+    {0xFE00707F, 0x20004033, &zba_instructions[1]},       // sh2add
+    {0xFE00707F, 0x20006033, &zba_instructions[2]},       // sh3add
+    {0xFE00707F, 0x40007033, &zbb_instructions[0]},       // andn
+    {0xFE00707F, 0x40006033, &zbb_instructions[1]},       // orn
+    {0xFE00707F, 0x40004033, &zbb_instructions[2]},       // xnor
+    {0xFE00707F, 0x0A004033, &zbb_instructions[3]},       // min
+    {0xFE00707F, 0x0A005033, &zbb_instructions[4]},       // minu
+    {0xFE00707F, 0x0A006033, &zbb_instructions[5]},       // max
+    {0xFE00707F, 0x0A007033, &zbb_instructions[6]},       // maxu
+    {0xFE00707F, 0x60001033, &zbb_instructions[7]},       // rol
+    {0xFE00707F, 0x60005033, &zbb_instructions[8]},       // ror
+    {0xFE00707F, 0x48001033, &zbs_instructions[0]},       // bclr
+    {0xFE00707F, 0x48005033, &zbs_instructions[1]},       // bext
+    {0xFE00707F, 0x68001033, &zbs_instructions[2]},       // binv
+    {0xFE00707F, 0x28001033, &zbs_instructions[3]},       // bset
+    {0xFE00707F, 0x0E005033, &zicond_instructions[0]},    // czero.eqz
+    {0xFE00707F, 0x0E007033, &zicond_instructions[1]},    // czero.nez
+    {0x0000007F, 0x00000037, &rv32i_instructions[34]},    // lui
+    {0xFFF0707F, 0x0800403B, &zbb_instructions[19]},      // zext.h
+    {0xFE00707F, 0x0000003B, &rv64i_instructions[7]},     // addw
+    {0xFE00707F, 0x4000003B, &rv64i_instructions[8]},     // subw
+    {0xFE00707F, 0x0000103B, &rv64i_instructions[9]},     // sllw
+    {0xFE00707F, 0x0000503B, &rv64i_instructions[10]},    // srlw
+    {0xFE00707F, 0x4000503B, &rv64i_instructions[11]},    // sraw
+    {0xFE00707F, 0x0200003B, &m_instructions[8]},         // mulw
+    {0xFE00707F, 0x0200403B, &m_instructions[9]},         // divw
+    {0xFE00707F, 0x0200503B, &m_instructions[10]},        // divuw
+    {0xFE00707F, 0x0200603B, &m_instructions[11]},        // remw
+    {0xFE00707F, 0x0200703B, &m_instructions[12]},        // remuw
+    {0xFE00707F, 0x0800003B, &zba_instructions[3]},       // add.uw
+    {0xFE00707F, 0x2000203B, &zba_instructions[4]},       // sh1add.uw
+    {0xFE00707F, 0x2000403B, &zba_instructions[5]},       // sh2add.uw
+    {0xFE00707F, 0x2000603B, &zba_instructions[6]},       // sh3add.uw
+    {0xFE00707F, 0x6000103B, &zbb_instructions[23]},      // rolw
+    {0xFE00707F, 0x6000503B, &zbb_instructions[24]},      // rorw
+    {0x0000707F, 0x00000063, &rv32i_instructions[28]},    // beq
+    {0x0000707F, 0x00001063, &rv32i_instructions[29]},    // bne
+    {0x0000707F, 0x00004063, &rv32i_instructions[30]},    // blt
+    {0x0000707F, 0x00005063, &rv32i_instructions[31]},    // bge
+    {0x0000707F, 0x00006063, &rv32i_instructions[32]},    // bltu
+    {0x0000707F, 0x00007063, &rv32i_instructions[33]},    // bgeu
+    {0x0000707F, 0x00000067, &rv32i_instructions[21]},    // jalr
+    {0x0000007F, 0x0000006F, &rv32i_instructions[36]},    // jal
+    {0xFFFFFFFF, 0x00000073, &zicsr_instructions[0]},     // ecall
+    {0xFFFFFFFF, 0x00100073, &zicsr_instructions[1]},     // ebreak
+    {0xFFFFFFFF, 0x30200073, &zicsr_instructions[2]},     // mret
+    {0x0000707F, 0x00001073, &zicsr_instructions[3]},     // csrrw
+    {0x0000707F, 0x00002073, &zicsr_instructions[4]},     // csrrs
+    {0x0000707F, 0x00003073, &zicsr_instructions[5]},     // csrrc
+    {0x0000707F, 0x00005073, &zicsr_instructions[6]},     // csrrwi
+    {0x0000707F, 0x00006073, &zicsr_instructions[7]},     // csrrsi
+    {0x0000707F, 0x00007073, &zicsr_instructions[8]},     // csrrci
+};
+
+// Range of decode_table entries for each major opcode (bits 6..0)
+static const struct {
+    uint16_t first;
+    uint16_t count;
+} decode_index[128] = {
+    [0x03] = {  0,  7},
+    [0x13] = {  7, 22},
+    [0x17] = { 29,  1},
+    [0x1B] = { 30,  9},
+    [0x23] = { 39,  4},
+    [0x33] = { 43, 37},
+    [0x37] = { 80,  1},
+    [0x3B] = { 81, 17},
+    [0x63] = { 98,  6},
+    [0x67] = {104,  1},
+    [0x6F] = {105,  1},
+    [0x73] = {106,  9},
+};
+
+const instr_def_t *decode_instruction(uint32_t word) {
+    const decode_entry_t *entry = &decode_table[decode_index[word & 0x7F].first];
+    for (int n = decode_index[word & 0x7F].count; n > 0; n--, entry++)
+        if ((word & entry->mask) == entry->match)
+            return entry->def;
+    return NULL;
+}
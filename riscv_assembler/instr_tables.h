@@ -0,0 +1,57 @@
+// instr_tables.h
+// Generated by gen_tables from opcodes/. Do not edit.
+#ifndef INSTR_TABLES_H
+#define INSTR_TABLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "instruction_defs.h"
+
+// RV32I
+extern instr_def_t rv32i_instructions[];
+extern size_t num_rv32i_instructions;
+
+// RV64I
+extern instr_def_t rv64i_instructions[];
+extern size_t num_rv64i_instructions;
+
+// Zicsr
+extern instr_def_t zicsr_instructions[];
+extern size_t num_zicsr_instructions;
+
+// M
+extern instr_def_t m_instructions[];
+extern size_t num_m_instructions;
+
+// Zba
+extern instr_def_t zba_instructions[];
+extern size_t num_zba_instructions;
+
+// Zbb
+extern instr_def_t zbb_instructions[];
+extern size_t num_zbb_instructions;
+
+// Zbs
+extern instr_def_t zbs_instructions[];
+extern size_t num_zbs_instructions;
+
+// Zicond
+extern instr_def_t zicond_instructions[];
+extern size_t num_zicond_instructions;
+
+// instr_def_t.id runs over every table, for per-instruction side tables
+#define NUM_INSTRUCTIONS 121
+
+// Constant-time mnemonic lookup through a perfect hash. Returns NULL if unknown.
+instr_def_t *lookup_mnemonic(const char *mnemonic);
+
+// The definition to use in an XLEN-bit image: `def` itself unless its
+// encoding is XLEN-specific. NULL if there is no encoding for that XLEN.
+const instr_def_t *xlen_variant(const instr_def_t *def, int xlen);
+
+// Definition whose fixed bits match the word; pseudo-instructions
+// are never returned. Returns NULL for an unknown encoding.
+const instr_def_t *decode_instruction(uint32_t word);
+
+#endif // INSTR_TABLES_H
@@ -3,6 +3,7 @@
 #define INSTRUCTION_DEFS_H
 
 #include "instruction_args.h"
+#include "isa_extensions.h"   // isa_extension_t, generated from opcodes/extensions
 #include <stdint.h>
 
 typedef enum {
@@ -17,17 +18,6 @@ typedef enum {
     TYPE_C     // For compressed extension
 } instr_format_t;
 
-typedef enum {
-    ISA_RV32I,      // Base ISA
-    ISA_RV64I,      // Base ISA
-    ISA_EXT_ZICSR,  // Control and Status Registers
-    ISA_EXT_M,      // Multiply/Divide
-    ISA_EXT_F,      // Single-precision float
-    ISA_EXT_D,      // Double-precision float
-    ISA_EXT_C,      // Compressed
-    ISA_EXT_V,      // Vector
-} isa_extension_t;
-
 typedef struct instr_def_t instr_def_t; // forward declaration for self-pointer
 int parse_operands(const char *operands,
                    instr_def_t *def,
@@ -40,8 +30,11 @@ struct instr_def_t {
     uint8_t funct3;            // funct3 field (if applicable)
     uint8_t funct7;            // funct7 field (if applicable)
     //uint8_t funct2;            // For R4 format
-    uint16_t funct12;          // for SYSTEM instructions only
+    uint16_t funct12;          // SYSTEM instructions, and unary R-type (rs2/funct7 fixed)
     isa_extension_t isa_ext;   // Which ISA extension this belongs to
+    uint8_t xlen;              // 32 or 64 if only valid at that XLEN, 0 for both
+    uint8_t shamt_bits;        // TYPE_I7: shamt field width, 5 (shamtw) or 6 (shamtd)
+    uint16_t id;               // Index over all tables, 0..NUM_INSTRUCTIONS-1
     uint32_t (*encoder)(const instr_def_t *, const void *);
     int      (*parser)(const instr_def_t *, const char *, void *);
 };
@@ -0,0 +1,25 @@
+// isa_extensions.h
+// Generated by gen_tables from opcodes/. Do not edit.
+#ifndef ISA_EXTENSIONS_H
+#define ISA_EXTENSIONS_H
+
+typedef enum {
+    ISA_RV32I,       // Base ISA
+    ISA_RV64I,       // Base ISA
+    ISA_EXT_ZICSR,   // Control and Status Registers
+    ISA_EXT_M,       // Multiply/Divide
+    ISA_EXT_F,       // Single-precision float
+    ISA_EXT_D,       // Double-precision float
+    ISA_EXT_C,       // Compressed
+    ISA_EXT_V,       // Vector
+    ISA_EXT_ZBA,     // Address generation
+    ISA_EXT_ZBB,     // Basic bit manipulation
+    ISA_EXT_ZBS,     // Single-bit instructions
+    ISA_EXT_ZICOND,  // Integer conditional operations
+    NUM_ISA_EXTENSIONS
+} isa_extension_t;
+
+// Display names, indexed by isa_extension_t
+#define ISA_EXTENSION_NAMES "RV32I", "RV64I", "Zicsr", "M", "F", "D", "C", "V", "Zba", "Zbb", "Zbs", "Zicond"
+
+#endif // ISA_EXTENSIONS_H
@@ -0,0 +1,330 @@
+// link.c
+#if !defined(_WIN32)
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include "link.h"
+#include "assembler.h"
+#include "encoder.h"
+
+/* ---------------------- Types ---------------------- */
+typedef struct {
+    const char *source;
+    uint32_t *words;
+    const instr_def_t **defs;
+    size_t num_words;
+    size_t capacity;
+    int out_of_memory;
+    label_t *labels;
+    int num_labels;
+    object_refs_t refs;
+    uint32_t base;          // load address assigned by the link step
+    int result;             // assemble_stream() result
+    FILE *diags;            // diagnostics captured while assembling
+} object_t;
+
+typedef struct {
+    object_t *objects;
+    int count;
+    int next;
+    int xlen;
+    pthread_mutex_t lock;
+} work_queue_t;
+
+typedef struct {
+    const char *name;       // NULL = empty slot
+    uint32_t address;
+    int object;
+} symbol_t;
+
+/* ---------------------- Object assembly ---------------------- */
+static void collect_object_word(void *ctx, const instr_def_t *def, const char *line, uint32_t machine) {
+    object_t *obj = (object_t *)ctx;
+    (void)line;
+
+    if (obj->out_of_memory)
+        return;
+    if (obj->num_words == obj->capacity) {
+        size_t new_capacity = obj->capacity ? obj->capacity * 2 : 256;
+        uint32_t *words = realloc(obj->words, new_capacity * sizeof(*words));
+        if (words) obj->words = words;
+        const instr_def_t **defs = realloc(obj->defs, new_capacity * sizeof(*defs));
+        if (defs) obj->defs = defs;
+        if (!words || !defs) { obj->out_of_memory = 1; return; }
+        obj->capacity = new_capacity;
+    }
+    obj->words[obj->num_words] = machine;
+    obj->defs[obj->num_words] = def;
+    obj->num_words++;
+}
+
+static void assemble_object(object_t *obj) {
+    obj->diags = tmpfile();
+    set_diag_stream(obj->diags);
+
+    FILE *in = fopen(obj->source, "r");
+    if (!in) {
+        diag("%s: Cannot open input file\n", obj->source);
+        obj->result = -1;
+    } else {
+        set_object_refs(&obj->refs);
+        obj->result = assemble_stream(in, obj->source, collect_object_word, obj);
+        set_object_refs(NULL);
+        fclose(in);
+
+        int count;
+        const label_t *labels = get_labels(&count);
+        obj->labels = malloc((count ? count : 1) * sizeof(*labels));
+        if (obj->labels) {
+            memcpy(obj->labels, labels, count * sizeof(*labels));
+            obj->num_labels = count;
+        } else {
+            obj->out_of_memory = 1;
+        }
+    }
+
+    set_diag_stream(NULL);
+}
+
+static void *link_worker(void *arg) {
+    work_queue_t *queue = (work_queue_t *)arg;
+    set_xlen(queue->xlen);
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (index >= queue->count)
+            break;
+        assemble_object(&queue->objects[index]);
+    }
+    return NULL;
+}
+
+static int worker_count(int num_sources) {
+    long cpus = 4;
+#if !defined(_WIN32)
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpus < 1) cpus = 1;
+    if (cpus > LINK_MAX_THREADS) cpus = LINK_MAX_THREADS;
+    return (num_sources < cpus) ? num_sources : (int)cpus;
+}
+
+// Replay an object's captured diagnostics on the caller's stream
+static void flush_object_diags(object_t *obj) {
+    char buf[512];
+
+    if (!obj->diags)
+        return;
+    rewind(obj->diags);
+    while (fgets(buf, sizeof(buf), obj->diags))
+        diag("%s", buf);
+    fclose(obj->diags);
+    obj->diags = NULL;
+}
+
+/* ---------------------- Symbol table ---------------------- */
+static uint32_t hash_symbol(const char *name) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Open addressing; `mask` + 1 is a power of two larger than the symbol count
+static symbol_t *find_symbol(symbol_t *table, size_t mask, const char *name) {
+    size_t i = hash_symbol(name) & mask;
+    while (table[i].name && strcmp(table[i].name, name) != 0)
+        i = (i + 1) & mask;
+    return &table[i];
+}
+
+static const label_t *find_object_label(const object_t *obj, const char *name) {
+    for (int i = 0; i < obj->num_labels; i++)
+        if (strcmp(obj->labels[i].name, name) == 0)
+            return &obj->labels[i];
+    return NULL;
+}
+
+/* ---------------------- Relocation ---------------------- */
+static int apply_reloc(uint32_t *word, const reloc_t *r, int32_t offset, const char *source) {
+    uint32_t w = *word;
+    int rd = (w >> 7) & 0x1F, rs1 = (w >> 15) & 0x1F, rs2 = (w >> 20) & 0x1F;
+    int funct3 = (w >> 12) & 0x7, opcode = w & 0x7F;
+
+    switch (r->kind) {
+        case RELOC_B:
+            if (offset % 2 != 0 || offset < -4096 || offset > 4094) {
+                diag("%s:%d: Branch to %s out of range after linking\n", source, r->line_no, r->symbol);
+                return 0;
+            }
+            *word = encode_B(offset, rs2, rs1, funct3, opcode);
+            return 1;
+
+        case RELOC_J:
+            if (offset % 2 != 0 || offset < -1048576 || offset > 1048574) {
+                diag("%s:%d: Jump to %s out of range after linking\n", source, r->line_no, r->symbol);
+                return 0;
+            }
+            *word = encode_J(offset, rd, opcode);
+            return 1;
+
+        case RELOC_PCREL_HI20:
+            *word = encode_U(pcrel_hi20(offset), rd, opcode);
+            return 1;
+
+        case RELOC_PCREL_LO12_I:
+            *word = encode_I(pcrel_lo12(offset), rs1, funct3, rd, opcode);
+            return 1;
+
+        case RELOC_PCREL_LO12_S:
+            *word = encode_S(pcrel_lo12(offset), rs2, rs1, funct3, opcode);
+            return 1;
+    }
+    return 0;
+}
+
+/* ---------------------- Link ---------------------- */
+int link_sources(const char *const *sources, int num_sources, int xlen, link_result_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    object_t *objects = calloc(num_sources, sizeof(*objects));
+    if (!objects) { diag("Out of memory\n"); return -1; }
+    for (int i = 0; i < num_sources; i++)
+        objects[i].source = sources[i];
+
+    /* ---------------------- Assemble objects in parallel ---------------------- */
+    work_queue_t queue = {objects, num_sources, 0, xlen, PTHREAD_MUTEX_INITIALIZER};
+    pthread_t workers[LINK_MAX_THREADS];
+    int num_workers = worker_count(num_sources);
+    int started = 0;
+
+    for (; started < num_workers; started++)
+        if (pthread_create(&workers[started], NULL, link_worker, &queue) != 0)
+            break;
+    if (started == 0)
+        link_worker(&queue);    // no threads available: assemble inline
+    for (int i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+
+    int errors = 0, fatal = 0;
+    size_t total_words = 0;
+    size_t total_labels = 0, total_globals = 0;
+
+    for (int i = 0; i < num_sources; i++) {
+        object_t *obj = &objects[i];
+        flush_object_diags(obj);
+        if (obj->result < 0 || obj->out_of_memory) fatal = 1;
+        else errors += obj->result;
+
+        obj->base = (uint32_t)(total_words * 4);
+        total_words += obj->num_words;
+        total_labels += obj->num_labels;
+        total_globals += obj->refs.num_globals;
+    }
+
+    /* ---------------------- Global symbol table ---------------------- */
+    size_t table_size = 16;
+    while (table_size < total_globals * 2) table_size *= 2;
+    symbol_t *symbols = calloc(table_size, sizeof(*symbols));
+
+    out->image  = malloc((total_words ? total_words : 1) * sizeof(*out->image));
+    out->defs   = malloc((total_words ? total_words : 1) * sizeof(*out->defs));
+    out->labels = malloc((total_labels ? total_labels : 1) * sizeof(*out->labels));
+
+    if (fatal || !symbols || !out->image || !out->defs || !out->labels) {
+        if (!fatal) diag("Out of memory\n");
+        errors = -1;
+        goto cleanup;
+    }
+
+    for (int i = 0; i < num_sources; i++) {
+        object_t *obj = &objects[i];
+        for (size_t g = 0; g < obj->refs.num_globals; g++) {
+            const char *name = obj->refs.globals[g];
+            const label_t *label = find_object_label(obj, name);
+            if (!label) {
+                diag("%s: .globl %s is not defined\n", obj->source, name);
+                errors++;
+                continue;
+            }
+
+            symbol_t *sym = find_symbol(symbols, table_size - 1, name);
+            if (sym->name) {
+                if (sym->object != i || sym->address != obj->base + label->address) {
+                    diag("%s: Duplicate symbol %s (also defined in %s)\n",
+                         obj->source, name, objects[sym->object].source);
+                    errors++;
+                }
+                continue;
+            }
+            sym->name = label->name;
+            sym->address = obj->base + label->address;
+            sym->object = i;
+        }
+    }
+
+    /* ---------------------- Lay out and patch ---------------------- */
+    for (int i = 0; i < num_sources; i++) {
+        object_t *obj = &objects[i];
+        uint32_t *words = out->image + obj->base / 4;
+
+        memcpy(words, obj->words, obj->num_words * sizeof(*words));
+        memcpy(out->defs + obj->base / 4, obj->defs, obj->num_words * sizeof(*out->defs));
+
+        for (int l = 0; l < obj->num_labels; l++) {
+            out->labels[out->num_labels] = obj->labels[l];
+            out->labels[out->num_labels].address += obj->base;
+            out->num_labels++;
+        }
+
+        for (size_t r = 0; r < obj->refs.num_relocs; r++) {
+            const reloc_t *reloc = &obj->refs.relocs[r];
+            symbol_t *sym = find_symbol(symbols, table_size - 1, reloc->symbol);
+            if (!sym->name) {
+                diag("%s:%d: Undefined symbol: %s\n", obj->source, reloc->line_no, reloc->symbol);
+                errors++;
+                continue;
+            }
+
+            uint32_t anchor = obj->base + reloc->anchor;
+            int32_t offset = (int32_t)sym->address - (int32_t)anchor;
+            if (!apply_reloc(&words[reloc->pc / 4], reloc, offset, obj->source))
+                errors++;
+        }
+    }
+    out->num_words = total_words;
+
+cleanup:
+    for (int i = 0; i < num_sources; i++) {
+        free(objects[i].words);
+        free(objects[i].defs);
+        free(objects[i].labels);
+        free_object_refs(&objects[i].refs);
+    }
+    free(objects);
+    free(symbols);
+    if (errors < 0)
+        free_link_result(out);
+    return errors;
+}
+
+void free_link_result(link_result_t *result) {
+    free(result->image);
+    free(result->labels);
+    free(result->defs);
+    memset(result, 0, sizeof(*result));
+}
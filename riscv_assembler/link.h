@@ -0,0 +1,27 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "assembler.h"
+
+#define LINK_MAX_THREADS 64
+
+typedef struct {
+    uint32_t *image;
+    size_t num_words;
+    label_t *labels;            // every label of every object, at its final address
+    int num_labels;
+    const instr_def_t **defs;   // definition of each word, for the instruction mix
+} link_result_t;
+
+// Assemble each source into an in-memory object on a pool of worker
+// threads, lay the objects out back to back in the given order, and patch
+// the B/J/auipc/%pcrel_lo references to .globl symbols of other objects
+// through a global symbol table. Every object is assembled for `xlen`.
+// Returns the number of diagnostics, or -1 on a fatal error.
+int link_sources(const char *const *sources, int num_sources, int xlen, link_result_t *out);
+void free_link_result(link_result_t *result);
+
+#endif // LINK_H
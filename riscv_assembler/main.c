@@ -2,202 +2,187 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 
-#include "encoder.h"
-#include "instruction_defs.h"
-#include "instruction_args.h"
-
-#define MAX_LINE_LEN 128
-#define MAX_LABELS 256
-#define MAX_LABEL_LEN 64
+#include "assembler.h"
+#include "link.h"
+#include "map.h"
+#include "output.h"
+#include "server.h"
+#include "simulator.h"
+#include "source.h"
 
 /* ---------------------- Types ---------------------- */
 typedef struct {
-    char name[MAX_LABEL_LEN];
-    uint32_t address;
-} label_t;
-
-/* ---------------------- Globals ---------------------- */
-label_t label_table[MAX_LABELS];
-int label_count = 0;
-
-/* ---------------------- Function prototypes ---------------------- */
-instr_def_t *find_instruction(const char *mnemonic);
-int parse_operands(const char *operands, instr_def_t *def, instr_args_t *args);
-int find_label(const char *name, uint32_t *address);
-
-/* ---------------------- Main ---------------------- */
-int main(int argc, char *argv[])
+    uint32_t *image;            // assembled words, written out after assembly
+    size_t image_count;
+    size_t image_capacity;
+    int out_of_memory;
+    instr_stats_t stats;        // instruction mix for --map
+} output_ctx_t;
+
+/* ---------------------- Output ---------------------- */
+static void emit_instruction(void *ctx, const instr_def_t *def, const char *line, uint32_t machine)
 {
-    if (argc != 4) {
-        printf("Usage: %s <input_file.s> <output_file.hex> <word|byte>\n", argv[0]);
-        return 1;
-    }
+    output_ctx_t *out = (output_ctx_t *)ctx;
 
-    const char *input_file_name  = argv[1];
-    const char *output_file_name = argv[2];
-    const char *mode             = argv[3];
-
-    int byte_mode = (strcmp(mode, "byte") == 0);
-
-    FILE *asm_file = fopen(input_file_name, "r");
-    if (!asm_file) { perror("Cannot open input file"); return 1; }
-
-    FILE *hex_file = fopen(output_file_name, "w");
-    if (!hex_file) { perror("Cannot open output file"); fclose(asm_file); return 1; }
-
-    char line[MAX_LINE_LEN];
-    char line_copy[MAX_LINE_LEN];
-    uint32_t pc = 0;
-
-    /* ---------------------- First pass: collect labels ---------------------- */
-    while (fgets(line, sizeof(line), asm_file)) {
-        line[strcspn(line, "\n")] = 0; // remove newline
-
-        char *comment = strchr(line, '#');
-        if (comment) *comment = '\0';
-
-        char *ptr = line;
-        while (isspace(*ptr)) ptr++;  // trim leading space
-        if (*ptr == '\0' || *ptr == '#') continue; // skip empty/comment lines
-
-        char *colon = strchr(ptr, ':');
-        if (colon) {
-            *colon = '\0';
-            if (label_count < MAX_LABELS) {
-                strcpy(label_table[label_count].name, ptr);
-                label_table[label_count].address = pc;
-                label_count++;
-            } else {
-                printf("Label table full!\n");
-                return 1;
-            }
-            continue; // label-only line
-        }
+    printf("%-18s -> %08X\n", line, machine);
 
-        pc += 4; // increment PC per instruction
-    }
+    if (!stats_add(&out->stats, def))
+        out->out_of_memory = 1;
 
-    rewind(asm_file);
-    pc = 0; // reset PC for second pass
-
-    /* ---------------------- Second pass: encode instructions ---------------------- */
-    while (fgets(line, sizeof(line), asm_file)) {
-        line[strcspn(line, "\n")] = 0;
-        char *comment = strchr(line, '#');
-        if (comment) *comment = '\0';
-        strcpy(line_copy, line);
-
-        char *ptr = line;
-        while (isspace(*ptr)) ptr++;  // trim leading space
-        if (*ptr == '\0' || *ptr == '#') continue; // skip empty/comment lines
-
-        // skip label-only lines
-        char *colon = strchr(ptr, ':');
-        if (colon) continue;
-
-        // trim trailing whitespace
-        char *end = ptr + strlen(ptr) - 1;
-        while (end > ptr && isspace(*end)) *end-- = '\0';
-        if (strlen(ptr) == 0) continue;
-
-        /* Extract mnemonic + operands */
-        char mnemonic[32] = {0};
-        char operands[128] = {0};
-
-        int i = 0;
-        while (*ptr && !isspace(*ptr) && i < 31) mnemonic[i++] = *ptr++;
-        mnemonic[i] = '\0';
-
-        while (isspace(*ptr)) ptr++;
-        strncpy(operands, ptr, sizeof(operands) - 1);
-        operands[sizeof(operands)-1] = '\0';
-
-        /* Find instruction */
-        instr_def_t *def = find_instruction(mnemonic);
-        if (!def) {
-            printf("Unknown instruction: %s\n", line_copy);
-            continue;
-        }
-
-        /* Parse operands */
-        instr_args_t args = {0};
-        args.current_pc = pc; // assign PC before parsing
-
-        if (!def->parser(def, operands, &args)) {
-            printf("Parse error: %s\n", line_copy);
-            continue;
+    if (!out->out_of_memory) {
+        if (out->image_count == out->image_capacity) {
+            size_t new_capacity = out->image_capacity ? out->image_capacity * 2 : 256;
+            uint32_t *grown = realloc(out->image, new_capacity * sizeof(*out->image));
+            if (!grown) { out->out_of_memory = 1; return; }
+            out->image = grown;
+            out->image_capacity = new_capacity;
         }
+        out->image[out->image_count++] = machine;
+    }
+}
 
-        /* Encode instruction */
-        uint32_t machine = def->encoder(def, &args);
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s <input_file.s> <output_file.hex> <mode> [options]\n", prog);
+    printf("       %s --link <output_file.hex> <mode> <input_file.s>... [options]\n", prog);
+    printf("       %s --serve <socket_path> [-I <dir>]... [--xlen 32|64]\n", prog);
+    printf("Modes: word, word64, word128, word256, word512, byte, verilog, coe, mif, ihex, run\n");
+    printf("Options: -I <dir>, --map <map_file>, --map-json <map_file>, --xlen 32|64 (default 32)\n");
+}
 
-        /* Output to file */
-        if (!byte_mode) {
-            fprintf(hex_file, "%08X\n", machine);
+/* ---------------------- Main ---------------------- */
+int main(int argc, char *argv[])
+{
+    int serve_mode = (argc >= 2 && strcmp(argv[1], "--serve") == 0);
+    int link_mode  = (argc >= 2 && strcmp(argv[1], "--link") == 0);
+    const char *map_file_name = NULL;
+    int map_json = 0;
+    int xlen = 32;
+
+    /* Split options from positional arguments */
+    const char **positional = malloc(argc * sizeof(*positional));
+    int num_positional = 0;
+    if (!positional) { printf("Out of memory\n"); return 1; }
+
+    for (int i = (serve_mode || link_mode) ? 2 : 1; i < argc; i++) {
+        int is_map  = (strcmp(argv[i], "--map") == 0);
+        int is_json = (strcmp(argv[i], "--map-json") == 0);
+        if ((is_map || is_json) && i + 1 < argc && !serve_mode) {
+            map_file_name = argv[++i];
+            map_json = is_json;
+        } else if (strcmp(argv[i], "--xlen") == 0 && i + 1 < argc) {
+            xlen = atoi(argv[++i]);
+            if (xlen != 32 && xlen != 64) { printf("--xlen must be 32 or 64\n"); return 1; }
+        } else if (strcmp(argv[i], "-I") == 0 && i + 1 < argc) {
+            if (!add_include_path(argv[++i])) { printf("Too many include paths\n"); return 1; }
+        } else if (strncmp(argv[i], "-I", 2) == 0 && argv[i][2]) {
+            if (!add_include_path(argv[i] + 2)) { printf("Too many include paths\n"); return 1; }
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            print_usage(argv[0]);
+            return 1;
         } else {
-            fprintf(hex_file, "%02X\n",  machine        & 0xFF);
-            fprintf(hex_file, "%02X\n", (machine >> 8)  & 0xFF);
-            fprintf(hex_file, "%02X\n", (machine >> 16) & 0xFF);
-            fprintf(hex_file, "%02X\n", (machine >> 24) & 0xFF);
+            positional[num_positional++] = argv[i];
         }
-
-        printf("%-18s -> %08X\n", line_copy, machine);
-
-        pc += 4; // increment PC
     }
 
-    fclose(asm_file);
-    fclose(hex_file);
-
-    printf("Assembly finished: %s -> %s (%s mode)\n",
-           input_file_name, output_file_name,
-           byte_mode ? "byte" : "word");
+    if (serve_mode) {
+        if (num_positional != 1) { print_usage(argv[0]); return 1; }
+        return serve(positional[0], xlen);
+    }
 
-    return 0;
-}
+    if (link_mode ? num_positional < 3 : num_positional != 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
 
-/* ---------------------- Find instruction ---------------------- */
-instr_def_t *find_instruction(const char *mnemonic) {
-    extern instr_def_t rv32i_instructions[];
-    extern size_t num_rv32i_instructions;
+    const char *input_file_name  = link_mode ? positional[2] : positional[0];
+    const char *output_file_name = link_mode ? positional[0] : positional[1];
+    const char *mode             = link_mode ? positional[1] : positional[2];
 
-    for (size_t i = 0; i < num_rv32i_instructions; i++)
-        if (strcmp(rv32i_instructions[i].mnemonic, mnemonic) == 0)
-            return &rv32i_instructions[i];
+    output_ctx_t out = {0};
+    output_spec_t spec;
+    int run_mode = (strcmp(mode, "run") == 0);   // word output, then execute
 
-    extern instr_def_t rv64i_instructions[];
-    extern size_t num_rv64i_instructions;
+    if (!parse_output_mode(run_mode ? "word" : mode, &spec)) {
+        printf("Unknown output mode: %s\n", mode);
+        return 1;
+    }
 
-    for (size_t i = 0; i < num_rv64i_instructions; i++)
-        if (strcmp(rv64i_instructions[i].mnemonic, mnemonic) == 0)
-            return &rv64i_instructions[i];
+    const label_t *labels;
+    int num_labels;
+    link_result_t linked = {0};
+    int result;
+
+    if (link_mode) {
+        /* Assemble every input into an object, then link them into one image */
+        result = link_sources(positional + 2, num_positional - 2, xlen, &linked);
+        out.image = linked.image;
+        out.image_count = linked.num_words;
+        for (size_t i = 0; i < linked.num_words && !out.out_of_memory; i++)
+            if (!stats_add(&out.stats, linked.defs[i]))
+                out.out_of_memory = 1;
+        labels = linked.labels;
+        num_labels = linked.num_labels;
+        linked.image = NULL;    // owned by out from here on
+    } else {
+        FILE *asm_file = fopen(input_file_name, "r");
+        if (!asm_file) { perror("Cannot open input file"); return 1; }
+
+        set_xlen(xlen);
+        result = assemble_stream(asm_file, input_file_name, emit_instruction, &out);
+        fclose(asm_file);
+        labels = get_labels(&num_labels);
+    }
 
-    extern instr_def_t m_instructions[];
-    extern size_t num_m_instructions;
+    // Unresolved or out-of-range references leave the image unpatched,
+    // so a link with any error produces nothing.
+    int failed = link_mode ? (result != 0) : (result < 0);
+    if (link_mode && result > 0)
+        printf("Link failed: %d error%s\n", result, result == 1 ? "" : "s");
+    if (!failed && out.out_of_memory) { printf("Out of memory\n"); failed = 1; }
+
+    /* The output file is only created once there is an image to put in it */
+    if (!failed) {
+        FILE *hex_file = fopen(output_file_name, "w");
+        int write_failed = !hex_file ||
+            write_image(hex_file, &spec, out.image, out.image_count) != 0;
+        if (hex_file && fclose(hex_file) != 0) write_failed = 1;
+        if (write_failed) { perror("Cannot write output file"); failed = 1; }
+    }
 
-    for (size_t i = 0; i < num_m_instructions; i++)
-        if (strcmp(m_instructions[i].mnemonic, mnemonic) == 0)
-            return &m_instructions[i];
+    if (!failed) {
+        if (link_mode)
+            printf("Link finished: %d files -> %s (%s mode)\n",
+                   num_positional - 2, output_file_name, mode);
+        else
+            printf("Assembly finished: %s -> %s (%s mode)\n",
+                   input_file_name, output_file_name, mode);
+    }
 
-    extern instr_def_t zicsr_instructions[];
-    extern size_t num_zicsr_instructions;
+    if (!failed && map_file_name) {
+        FILE *map_file = fopen(map_file_name, "w");
+        int map_failed = !map_file ||
+            write_map(map_file, labels, num_labels, (uint32_t)(out.image_count * 4), &out.stats, map_json) != 0;
+        if (map_file && fclose(map_file) != 0) map_failed = 1;
+        if (map_failed) { perror("Cannot write map file"); failed = 1; }
+    }
 
-    for (size_t i = 0; i < num_zicsr_instructions; i++)
-        if (strcmp(zicsr_instructions[i].mnemonic, mnemonic) == 0)
-            return &zicsr_instructions[i];
+    stats_free(&out.stats);
+    free_link_result(&linked);
+    free(positional);
 
-    return NULL; // Not found
-}
+    if (failed) {
+        free(out.image);
+        return 1;
+    }
 
-/* ---------------------- Find label ---------------------- */
-int find_label(const char *name, uint32_t *address) {
-    for (int i = 0; i < label_count; i++) {
-        if (strcmp(label_table[i].name, name) == 0) {
-            *address = label_table[i].address;
-            return 1;
-        }
+    if (run_mode) {
+        int exit_code = simulate(out.image, out.image_count, xlen);
+        free(out.image);
+        return exit_code;
     }
+
+    free(out.image);
     return 0;
 }
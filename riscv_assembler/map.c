@@ -0,0 +1,177 @@
+// map.c
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "map.h"
+
+static const char *const format_names[MAP_NUM_FORMATS] = {
+    "R", "I", "I7", "S", "B", "U", "J", "R4", "C"
+};
+
+static const char *const extension_names[MAP_NUM_EXTENSIONS] = {
+    ISA_EXTENSION_NAMES
+};
+
+/* ---------------------- Statistics ---------------------- */
+int stats_add(instr_stats_t *stats, const instr_def_t *def) {
+    stats->total++;
+    if ((unsigned)def->format < MAP_NUM_FORMATS)
+        stats->per_format[def->format]++;
+    if ((unsigned)def->isa_ext < MAP_NUM_EXTENSIONS)
+        stats->per_extension[def->isa_ext]++;
+
+    // Mnemonic strings come from the instruction tables, so pointers are unique
+    for (size_t i = 0; i < stats->num_mnemonics; i++) {
+        if (stats->mnemonics[i].mnemonic == def->mnemonic) {
+            stats->mnemonics[i].count++;
+            return 1;
+        }
+    }
+
+    if (stats->num_mnemonics == stats->mnemonics_capacity) {
+        size_t new_capacity = stats->mnemonics_capacity ? stats->mnemonics_capacity * 2 : 32;
+        mnemonic_count_t *grown = realloc(stats->mnemonics, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        stats->mnemonics = grown;
+        stats->mnemonics_capacity = new_capacity;
+    }
+    stats->mnemonics[stats->num_mnemonics].mnemonic = def->mnemonic;
+    stats->mnemonics[stats->num_mnemonics].count = 1;
+    stats->num_mnemonics++;
+    return 1;
+}
+
+void stats_free(instr_stats_t *stats) {
+    free(stats->mnemonics);
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* ---------------------- Helpers ---------------------- */
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Most frequent first, ties by name
+static int compare_mnemonic_count(const void *a, const void *b) {
+    const mnemonic_count_t *x = a, *y = b;
+    if (x->count != y->count)
+        return (x->count < y->count) ? 1 : -1;
+    return strcmp(x->mnemonic, y->mnemonic);
+}
+
+// A region runs from its label to the next higher label address (or end of code)
+static uint32_t region_size(uint32_t address, const uint32_t *sorted, int count, uint32_t code_size) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sorted[mid] <= address) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t end = (lo < count) ? sorted[lo] : code_size;
+    return (end > address) ? end - address : 0;
+}
+
+static void put_json_string(FILE *file, const char *s) {
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(file, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(file, "\\u%04x", (unsigned char)*s);
+        else
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+/* ---------------------- Text map ---------------------- */
+static void write_map_text(FILE *file, const label_t *labels, int num_labels,
+                           const uint32_t *sorted, uint32_t code_size,
+                           const instr_stats_t *stats) {
+    fprintf(file, "Symbol map (%u bytes of code)\n\n", code_size);
+    fprintf(file, "  Address       Size  Label\n");
+    for (int i = 0; i < num_labels; i++) {
+        fprintf(file, "  %08X  %9u  %s\n", labels[i].address,
+                region_size(labels[i].address, sorted, num_labels, code_size),
+                labels[i].name);
+    }
+
+    fprintf(file, "\nInstruction mix (%zu instructions)\n", stats->total);
+
+    fprintf(file, "\n  By format:\n");
+    for (int i = 0; i < MAP_NUM_FORMATS; i++)
+        if (stats->per_format[i])
+            fprintf(file, "    %-10s %9zu\n", format_names[i], stats->per_format[i]);
+
+    fprintf(file, "\n  By extension:\n");
+    for (int i = 0; i < MAP_NUM_EXTENSIONS; i++)
+        if (stats->per_extension[i])
+            fprintf(file, "    %-10s %9zu\n", extension_names[i], stats->per_extension[i]);
+
+    fprintf(file, "\n  By mnemonic:\n");
+    for (size_t i = 0; i < stats->num_mnemonics; i++)
+        fprintf(file, "    %-10s %9zu\n", stats->mnemonics[i].mnemonic, stats->mnemonics[i].count);
+}
+
+/* ---------------------- JSON map ---------------------- */
+static void write_map_json(FILE *file, const label_t *labels, int num_labels,
+                           const uint32_t *sorted, uint32_t code_size,
+                           const instr_stats_t *stats) {
+    fprintf(file, "{\n  \"code_size\": %u,\n  \"instructions\": %zu,\n", code_size, stats->total);
+
+    fprintf(file, "  \"labels\": [");
+    for (int i = 0; i < num_labels; i++) {
+        fprintf(file, "%s\n    {\"name\": ", i ? "," : "");
+        put_json_string(file, labels[i].name);
+        fprintf(file, ", \"address\": %u, \"size\": %u}", labels[i].address,
+                region_size(labels[i].address, sorted, num_labels, code_size));
+    }
+    fprintf(file, "%s],\n", num_labels ? "\n  " : "");
+
+    int first = 1;
+    fprintf(file, "  \"formats\": {");
+    for (int i = 0; i < MAP_NUM_FORMATS; i++) {
+        if (!stats->per_format[i]) continue;
+        fprintf(file, "%s\"%s\": %zu", first ? "" : ", ", format_names[i], stats->per_format[i]);
+        first = 0;
+    }
+    fprintf(file, "},\n");
+
+    first = 1;
+    fprintf(file, "  \"extensions\": {");
+    for (int i = 0; i < MAP_NUM_EXTENSIONS; i++) {
+        if (!stats->per_extension[i]) continue;
+        fprintf(file, "%s\"%s\": %zu", first ? "" : ", ", extension_names[i], stats->per_extension[i]);
+        first = 0;
+    }
+    fprintf(file, "},\n");
+
+    fprintf(file, "  \"mnemonics\": {");
+    for (size_t i = 0; i < stats->num_mnemonics; i++)
+        fprintf(file, "%s\"%s\": %zu", i ? ", " : "", stats->mnemonics[i].mnemonic, stats->mnemonics[i].count);
+    fprintf(file, "}\n}\n");
+}
+
+/* ---------------------- Public API ---------------------- */
+int write_map(FILE *file, const label_t *labels, int num_labels,
+              uint32_t code_size, instr_stats_t *stats, int json) {
+    uint32_t *sorted = malloc((num_labels ? num_labels : 1) * sizeof(*sorted));
+    if (!sorted) return -1;
+    for (int i = 0; i < num_labels; i++)
+        sorted[i] = labels[i].address;
+    qsort(sorted, num_labels, sizeof(*sorted), compare_u32);
+
+    if (stats->num_mnemonics)
+        qsort(stats->mnemonics, stats->num_mnemonics, sizeof(*stats->mnemonics), compare_mnemonic_count);
+
+    if (json)
+        write_map_json(file, labels, num_labels, sorted, code_size, stats);
+    else
+        write_map_text(file, labels, num_labels, sorted, code_size, stats);
+
+    free(sorted);
+    return ferror(file) ? -1 : 0;
+}
@@ -0,0 +1,40 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "instruction_defs.h"
+#include "assembler.h"
+
+#define MAP_NUM_FORMATS 9      // TYPE_R .. TYPE_C
+#define MAP_NUM_EXTENSIONS NUM_ISA_EXTENSIONS
+
+typedef struct {
+    const char *mnemonic;
+    size_t count;
+} mnemonic_count_t;
+
+// Instruction mix collected while assembling
+typedef struct {
+    size_t total;
+    size_t per_format[MAP_NUM_FORMATS];
+    size_t per_extension[MAP_NUM_EXTENSIONS];
+    mnemonic_count_t *mnemonics;
+    size_t num_mnemonics;
+    size_t mnemonics_capacity;
+} instr_stats_t;
+
+// Count one emitted instruction. Returns 0 if out of memory.
+int stats_add(instr_stats_t *stats, const instr_def_t *def);
+void stats_free(instr_stats_t *stats);
+
+// Write the symbol map (every label with its address and the size of the
+// region it starts) followed by the instruction mix histograms.
+// code_size is the image size in bytes; it ends the last region.
+// The mnemonic list is sorted in place, most frequent first.
+int write_map(FILE *file, const label_t *labels, int num_labels,
+              uint32_t code_size, instr_stats_t *stats, int json);
+
+#endif // MAP_H
@@ -0,0 +1,195 @@
+// output.c
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "output.h"
+
+#define WRITER_BUF_SIZE 65536
+#define VERILOG_WORDS_PER_LINE 4
+#define IHEX_BYTES_PER_RECORD 16
+
+/* ---------------------- Buffered writer ---------------------- */
+// Every format is produced through this writer, so the file sees
+// a few large fwrite() calls instead of one fprintf() per value.
+typedef struct {
+    FILE *file;
+    size_t len;
+    int failed;
+    char buf[WRITER_BUF_SIZE];
+} writer_t;
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static void flush_writer(writer_t *w) {
+    if (w->len && fwrite(w->buf, 1, w->len, w->file) != w->len)
+        w->failed = 1;
+    w->len = 0;
+}
+
+static void put_char(writer_t *w, char c) {
+    if (w->len == WRITER_BUF_SIZE)
+        flush_writer(w);
+    w->buf[w->len++] = c;
+}
+
+static void put_str(writer_t *w, const char *s) {
+    while (*s)
+        put_char(w, *s++);
+}
+
+// Upper-case hex with a fixed number of digits
+static void put_hex(writer_t *w, uint32_t value, int digits) {
+    if (w->len + digits > WRITER_BUF_SIZE)
+        flush_writer(w);
+    for (int i = digits - 1; i >= 0; i--)
+        w->buf[w->len++] = hex_digits[(value >> (i * 4)) & 0xF];
+}
+
+/* ---------------------- Formats ---------------------- */
+// Little-endian packing: the word at the lowest address ends up rightmost
+static void write_words(writer_t *w, const uint32_t *image, size_t num_words, int width) {
+    size_t per_line = (size_t)width / 32;
+    for (size_t base = 0; base < num_words; base += per_line) {
+        for (size_t j = per_line; j-- > 0; ) {
+            size_t idx = base + j;
+            put_hex(w, idx < num_words ? image[idx] : 0, 8);
+        }
+        put_char(w, '\n');
+    }
+}
+
+static void write_bytes(writer_t *w, const uint32_t *image, size_t num_words) {
+    for (size_t i = 0; i < num_words; i++) {
+        for (int b = 0; b < 4; b++) {
+            put_hex(w, (image[i] >> (b * 8)) & 0xFF, 2);
+            put_char(w, '\n');
+        }
+    }
+}
+
+static void write_verilog(writer_t *w, const uint32_t *image, size_t num_words) {
+    put_char(w, '@');
+    put_hex(w, 0, 8);   // word address of the first value
+    put_char(w, '\n');
+    for (size_t i = 0; i < num_words; i++) {
+        put_hex(w, image[i], 8);
+        int last_in_line = (i % VERILOG_WORDS_PER_LINE == VERILOG_WORDS_PER_LINE - 1);
+        put_char(w, (last_in_line || i + 1 == num_words) ? '\n' : ' ');
+    }
+}
+
+static void write_coe(writer_t *w, const uint32_t *image, size_t num_words) {
+    put_str(w, "memory_initialization_radix=16;\n");
+    put_str(w, "memory_initialization_vector=\n");
+    for (size_t i = 0; i < num_words; i++) {
+        put_hex(w, image[i], 8);
+        put_str(w, (i + 1 == num_words) ? ";\n" : ",\n");
+    }
+    if (num_words == 0)
+        put_str(w, "0;\n");
+}
+
+static void write_mif(writer_t *w, const uint32_t *image, size_t num_words) {
+    char header[128];
+    snprintf(header, sizeof(header),
+             "DEPTH = %zu;\nWIDTH = 32;\nADDRESS_RADIX = HEX;\nDATA_RADIX = HEX;\n",
+             num_words ? num_words : 1);
+    put_str(w, header);
+    put_str(w, "CONTENT\nBEGIN\n");
+    for (size_t i = 0; i < num_words; i++) {
+        put_hex(w, (uint32_t)i, 8);
+        put_str(w, " : ");
+        put_hex(w, image[i], 8);
+        put_str(w, ";\n");
+    }
+    put_str(w, "END;\n");
+}
+
+static void put_ihex_record(writer_t *w, uint8_t type, uint16_t addr,
+                            const uint8_t *data, size_t len) {
+    uint8_t sum = (uint8_t)(len + (addr >> 8) + (addr & 0xFF) + type);
+
+    put_char(w, ':');
+    put_hex(w, (uint32_t)len, 2);
+    put_hex(w, addr, 4);
+    put_hex(w, type, 2);
+    for (size_t i = 0; i < len; i++) {
+        put_hex(w, data[i], 2);
+        sum += data[i];
+    }
+    put_hex(w, (uint8_t)-sum, 2);
+    put_char(w, '\n');
+}
+
+static void write_ihex(writer_t *w, const uint32_t *image, size_t num_words) {
+    size_t total = num_words * 4;
+    uint32_t upper = 0;
+    uint8_t data[IHEX_BYTES_PER_RECORD];
+
+    for (size_t addr = 0; addr < total; addr += IHEX_BYTES_PER_RECORD) {
+        // Extended linear address record when crossing a 64 KiB boundary
+        if ((addr >> 16) != upper) {
+            upper = (uint32_t)(addr >> 16);
+            uint8_t ext[2] = {(uint8_t)(upper >> 8), (uint8_t)upper};
+            put_ihex_record(w, 0x04, 0, ext, 2);
+        }
+
+        size_t len = total - addr;
+        if (len > IHEX_BYTES_PER_RECORD) len = IHEX_BYTES_PER_RECORD;
+        for (size_t i = 0; i < len; i++)
+            data[i] = (image[(addr + i) / 4] >> (((addr + i) % 4) * 8)) & 0xFF;
+
+        put_ihex_record(w, 0x00, (uint16_t)addr, data, len);
+    }
+    put_ihex_record(w, 0x01, 0, NULL, 0);   // end of file
+}
+
+/* ---------------------- Public API ---------------------- */
+int parse_output_mode(const char *mode, output_spec_t *spec) {
+    static const struct { const char *name; output_format_t format; int width; } modes[] = {
+        {"word",    OUT_WORD,    32},
+        {"word64",  OUT_WORD,    64},
+        {"word128", OUT_WORD,    128},
+        {"word256", OUT_WORD,    256},
+        {"word512", OUT_WORD,    512},
+        {"byte",    OUT_BYTE,    8},
+        {"verilog", OUT_VERILOG, 32},
+        {"coe",     OUT_COE,     32},
+        {"mif",     OUT_MIF,     32},
+        {"ihex",    OUT_IHEX,    8},
+    };
+
+    for (size_t i = 0; i < sizeof(modes)/sizeof(modes[0]); i++) {
+        if (strcmp(mode, modes[i].name) == 0) {
+            spec->format = modes[i].format;
+            spec->width  = modes[i].width;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int write_image(FILE *file, const output_spec_t *spec,
+                const uint32_t *image, size_t num_words) {
+    writer_t *w = malloc(sizeof(*w));
+    if (!w) return -1;
+    w->file = file;
+    w->len = 0;
+    w->failed = 0;
+
+    switch (spec->format) {
+        case OUT_WORD:    write_words(w, image, num_words, spec->width); break;
+        case OUT_BYTE:    write_bytes(w, image, num_words); break;
+        case OUT_VERILOG: write_verilog(w, image, num_words); break;
+        case OUT_COE:     write_coe(w, image, num_words); break;
+        case OUT_MIF:     write_mif(w, image, num_words); break;
+        case OUT_IHEX:    write_ihex(w, image, num_words); break;
+    }
+
+    flush_writer(w);
+    int result = w->failed ? -1 : 0;
+    free(w);
+    return result;
+}
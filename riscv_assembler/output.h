@@ -0,0 +1,31 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    OUT_WORD,      // one word per line (32..512 bits, little-endian packed)
+    OUT_BYTE,      // one byte per line
+    OUT_VERILOG,   // $readmemh with @address records
+    OUT_COE,       // Xilinx coefficient file
+    OUT_MIF,       // Intel/Altera memory initialization file
+    OUT_IHEX       // Intel HEX records
+} output_format_t;
+
+typedef struct {
+    output_format_t format;
+    int width;     // line width in bits for OUT_WORD
+} output_spec_t;
+
+// Parse a mode name: word, word64, word128, word256, word512, byte,
+// verilog, coe, mif, ihex. Returns 0 for an unknown mode.
+int parse_output_mode(const char *mode, output_spec_t *spec);
+
+// Write the image (loaded at address 0) in the requested format.
+// Returns 0 on success, -1 on a write error.
+int write_image(FILE *file, const output_spec_t *spec,
+                const uint32_t *image, size_t num_words);
+
+#endif // OUTPUT_H
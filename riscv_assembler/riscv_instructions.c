@@ -2,12 +2,12 @@
 #include "instruction_defs.h"
 #include "encoder.h"
 #include "riscv_instructions.h"
+#include "assembler.h"
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-
-extern int find_label(const char *name, uint32_t *address);
+#include <pthread.h>
 
 int is_number(const char *str) {
     if (*str == '-' || *str == '+')
@@ -28,332 +28,467 @@ int parse_number(const char *str) {
     return (int)strtol(str, NULL, 0);  // supports decimal & 0x hex
 }
 
+void error(const char *msg) {
+    diag_line("Error: %s\n", msg);
+}
+
 typedef struct {
     const char *name;
     uint16_t addr;
 } csr_def_t;
 
-csr_def_t csr_table[] = {
-    {"mstatus", 0x300},
-    {"misa", 0x301},
-    {"mie", 0x304},
-    {"mtvec",  0x305},
-    {"mepc",   0x341},
-    {"mcause", 0x342},
-    {"mtval",  0x343},
-    {"mip", 0x344}
+// Numbered CSR families, expanded with the X-macros below
+#define CSR_N_0_15(X, name, base) \
+    X(name, base, 0)  X(name, base, 1)  X(name, base, 2)  X(name, base, 3)  \
+    X(name, base, 4)  X(name, base, 5)  X(name, base, 6)  X(name, base, 7)  \
+    X(name, base, 8)  X(name, base, 9)  X(name, base, 10) X(name, base, 11) \
+    X(name, base, 12) X(name, base, 13) X(name, base, 14) X(name, base, 15)
+#define CSR_N_3_31(X, name, base) \
+    X(name, base, 3)  X(name, base, 4)  X(name, base, 5)  X(name, base, 6)  \
+    X(name, base, 7)  X(name, base, 8)  X(name, base, 9)  X(name, base, 10) \
+    X(name, base, 11) X(name, base, 12) X(name, base, 13) X(name, base, 14) \
+    X(name, base, 15) X(name, base, 16) X(name, base, 17) X(name, base, 18) \
+    X(name, base, 19) X(name, base, 20) X(name, base, 21) X(name, base, 22) \
+    X(name, base, 23) X(name, base, 24) X(name, base, 25) X(name, base, 26) \
+    X(name, base, 27) X(name, base, 28) X(name, base, 29) X(name, base, 30) \
+    X(name, base, 31)
+#define CSR_N_0_63(X, name, base) \
+    CSR_N_0_15(X, name, base) \
+    X(name, base, 16) X(name, base, 17) X(name, base, 18) X(name, base, 19) \
+    X(name, base, 20) X(name, base, 21) X(name, base, 22) X(name, base, 23) \
+    X(name, base, 24) X(name, base, 25) X(name, base, 26) X(name, base, 27) \
+    X(name, base, 28) X(name, base, 29) X(name, base, 30) X(name, base, 31) \
+    X(name, base, 32) X(name, base, 33) X(name, base, 34) X(name, base, 35) \
+    X(name, base, 36) X(name, base, 37) X(name, base, 38) X(name, base, 39) \
+    X(name, base, 40) X(name, base, 41) X(name, base, 42) X(name, base, 43) \
+    X(name, base, 44) X(name, base, 45) X(name, base, 46) X(name, base, 47) \
+    X(name, base, 48) X(name, base, 49) X(name, base, 50) X(name, base, 51) \
+    X(name, base, 52) X(name, base, 53) X(name, base, 54) X(name, base, 55) \
+    X(name, base, 56) X(name, base, 57) X(name, base, 58) X(name, base, 59) \
+    X(name, base, 60) X(name, base, 61) X(name, base, 62) X(name, base, 63)
+
+#define CSR_ENTRY(name, base, n)   {name #n, (base) + (n)},
+#define CSR_ENTRY_H(name, base, n) {name #n "h", (base) + (n)},
+
+static const csr_def_t csr_table[] = {
+    // Unprivileged floating-point CSRs
+    {"fflags", 0x001}, {"frm", 0x002}, {"fcsr", 0x003},
+
+    // Unprivileged counters/timers (read-only)
+    {"cycle", 0xC00}, {"time", 0xC01}, {"instret", 0xC02},
+    CSR_N_3_31(CSR_ENTRY, "hpmcounter", 0xC00)
+    {"cycleh", 0xC80}, {"timeh", 0xC81}, {"instreth", 0xC82},
+    CSR_N_3_31(CSR_ENTRY_H, "hpmcounter", 0xC80)
+
+    // Supervisor trap setup, configuration, trap handling, protection
+    {"sstatus", 0x100}, {"sie", 0x104}, {"stvec", 0x105}, {"scounteren", 0x106},
+    {"senvcfg", 0x10A},
+    {"sscratch", 0x140}, {"sepc", 0x141}, {"scause", 0x142}, {"stval", 0x143},
+    {"sip", 0x144},
+    {"satp", 0x180},
+    {"scontext", 0x5A8},
+
+    // Machine information registers (read-only)
+    {"mvendorid", 0xF11}, {"marchid", 0xF12}, {"mimpid", 0xF13},
+    {"mhartid", 0xF14}, {"mconfigptr", 0xF15},
+
+    // Machine trap setup
+    {"mstatus", 0x300}, {"misa", 0x301}, {"medeleg", 0x302}, {"mideleg", 0x303},
+    {"mie", 0x304}, {"mtvec", 0x305}, {"mcounteren", 0x306}, {"mstatush", 0x310},
+
+    // Machine trap handling
+    {"mscratch", 0x340}, {"mepc", 0x341}, {"mcause", 0x342}, {"mtval", 0x343},
+    {"mip", 0x344}, {"mtinst", 0x34A}, {"mtval2", 0x34B},
+
+    // Machine configuration
+    {"menvcfg", 0x30A}, {"menvcfgh", 0x31A}, {"mseccfg", 0x747}, {"mseccfgh", 0x757},
+
+    // Machine memory protection
+    CSR_N_0_15(CSR_ENTRY, "pmpcfg", 0x3A0)
+    CSR_N_0_63(CSR_ENTRY, "pmpaddr", 0x3B0)
+
+    // Machine counters/timers
+    {"mcycle", 0xB00}, {"minstret", 0xB02},
+    CSR_N_3_31(CSR_ENTRY, "mhpmcounter", 0xB00)
+    {"mcycleh", 0xB80}, {"minstreth", 0xB82},
+    CSR_N_3_31(CSR_ENTRY_H, "mhpmcounter", 0xB80)
+
+    // Machine counter setup
+    {"mcountinhibit", 0x320},
+    CSR_N_3_31(CSR_ENTRY, "mhpmevent", 0x320)
+
+    // Debug/trace registers
+    {"tselect", 0x7A0}, {"tdata1", 0x7A1}, {"tdata2", 0x7A2}, {"tdata3", 0x7A3},
+    {"mcontext", 0x7A8},
+    {"dcsr", 0x7B0}, {"dpc", 0x7B1}, {"dscratch0", 0x7B2}, {"dscratch1", 0x7B3},
 };
 
 #define NUM_CSR (sizeof(csr_table)/sizeof(csr_table[0]))
+#define CSR_HASH_SIZE 1024   // power of two, over twice NUM_CSR
+
+// Open-addressing index into csr_table; slot holds table index + 1 (0 = empty)
+static uint16_t csr_hash[CSR_HASH_SIZE];
+static pthread_once_t csr_hash_once = PTHREAD_ONCE_INIT;
+
+static uint32_t hash_csr(const char *name) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void build_csr_hash(void) {
+    for (size_t i = 0; i < NUM_CSR; i++) {
+        uint32_t slot = hash_csr(csr_table[i].name) & (CSR_HASH_SIZE - 1);
+        while (csr_hash[slot])
+            slot = (slot + 1) & (CSR_HASH_SIZE - 1);
+        csr_hash[slot] = (uint16_t)(i + 1);
+    }
+}
 
 int lookup_csr(const char *name, uint16_t *out) {
-    for (int i = 0; i < NUM_CSR; i++) {
-        if (strcmp(name, csr_table[i].name) == 0) {
-            *out = csr_table[i].addr;
+    pthread_once(&csr_hash_once, build_csr_hash);
+
+    uint32_t slot = hash_csr(name) & (CSR_HASH_SIZE - 1);
+    while (csr_hash[slot]) {
+        const csr_def_t *csr = &csr_table[csr_hash[slot] - 1];
+        if (strcmp(name, csr->name) == 0) {
+            *out = csr->addr;
             return 1;
         }
+        slot = (slot + 1) & (CSR_HASH_SIZE - 1);
     }
     return 0;
 }
 
-void error(const char *msg) {
-    printf("Error: %s\n", msg);
+// CSRs that hold the upper 32 bits of a 64-bit register on RV32 only
+static int is_rv32_only_csr(uint16_t addr) {
+    return (addr >= 0xC80 && addr <= 0xC9F) ||    // cycleh .. hpmcounter31h
+           (addr >= 0xB80 && addr <= 0xB9F) ||    // mcycleh .. mhpmcounter31h
+           (addr >= 0x3A1 && addr <= 0x3AF && (addr & 1)) ||  // odd pmpcfg
+           addr == 0x310 || addr == 0x31A || addr == 0x757;   // mstatush, menvcfgh, mseccfgh
+}
+
+// Resolve a CSR operand given by name or number. Writes to a read-only
+// CSR (address bits [11:10] == 0b11) trap at run time, and so do the
+// RV32-only upper halves on RV64, so warn about both.
+static int resolve_csr(const char *csr, int writes, int *out) {
+    uint16_t addr;
+
+    if (is_number(csr)) {
+        int value = parse_number(csr);
+        if (value < 0 || value > 0xFFF) {
+            diag_line("Error: CSR address %s out of range\n", csr);
+            return 0;
+        }
+        addr = (uint16_t)value;
+    } else if (!lookup_csr(csr, &addr)) {
+        diag_line("Error: Unknown CSR %s\n", csr);
+        return 0;
+    }
+
+    if (writes && (addr >> 10) == 0x3)
+        warn("Write to read-only CSR %s\n", csr);
+    if (get_xlen() == 64 && is_rv32_only_csr(addr))
+        warn("CSR %s only exists on RV32\n", csr);
+    *out = addr;
+    return 1;
+}
+
+// %pcrel_lo(anchor): the low 12 bits that complete the auipc at label
+// `anchor`, so the offset is measured from that auipc, not from here.
+static int resolve_pcrel_lo(const char *anchor, reloc_kind_t kind, instr_args_t *a) {
+    uint32_t auipc_pc, target;
+    const char *symbol;
+
+    if (!find_label(anchor, &auipc_pc)) {
+        diag_line("Unknown label: %s\n", anchor);
+        return 0;
+    }
+    symbol = find_pcrel_hi(auipc_pc);
+    if (!symbol) {
+        diag_line("%%pcrel_lo(%s) does not name an earlier auipc with a label operand\n", anchor);
+        return 0;
+    }
+
+    if (find_label(symbol, &target)) {
+        a->imm = pcrel_lo12((int32_t)target - (int32_t)auipc_pc);
+        return 1;
+    }
+    if (defer_pcrel_lo(symbol, kind, a->current_pc, auipc_pc)) {
+        a->imm = 0;
+        return 1;
+    }
+    diag_line("Unknown label: %s\n", symbol);
+    return 0;
 }
 
 // ==================== ENCODING FUNCTIONS ====================
-static uint32_t encode_dispatch(const instr_def_t *def, const void *args) {
+// One encoder per instruction format; the generated tables in
+// instr_tables.c point every definition at the right one.
+uint32_t encode_r_type(const instr_def_t *def, const void *args) {
     const instr_args_t *a = (const instr_args_t *)args;
+    return encode_R(def->funct7, a->rs2, a->rs1, def->funct3, a->rd, def->opcode);
+}
 
-    switch (def->format) {
-        case TYPE_R:
-            return encode_R(def->funct7, a->rs2, a->rs1, def->funct3, a->rd, def->opcode);
+// Unary R-type: rs2/funct7 fixed by funct12
+uint32_t encode_r1_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_R1(def->funct12, a->rs1, def->funct3, a->rd, def->opcode);
+}
 
-        case TYPE_I:
-            return encode_I(a->imm, a->rs1, def->funct3, a->rd, def->opcode);
+uint32_t encode_i_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_I(a->imm, a->rs1, def->funct3, a->rd, def->opcode);
+}
 
-        case TYPE_I7:
-            return encode_I7(def->funct7, a->shamt, a->rs1, def->funct3, a->rd, def->opcode);
+uint32_t encode_i7_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    int shamt = a->shamt & ((1 << def->shamt_bits) - 1);
+    return encode_I7(def->funct7, shamt, a->rs1, def->funct3, a->rd, def->opcode);
+}
 
-        case TYPE_S:
-            return encode_S(a->imm, a->rs2, a->rs1, def->funct3, def->opcode);
+uint32_t encode_s_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_S(a->imm, a->rs2, a->rs1, def->funct3, def->opcode);
+}
 
-        case TYPE_B:
-            return encode_B(a->imm, a->rs2, a->rs1, def->funct3, def->opcode);
+uint32_t encode_b_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_B(a->imm, a->rs2, a->rs1, def->funct3, def->opcode);
+}
 
-        case TYPE_U:
-            return encode_U(a->imm, a->rd, def->opcode);
+uint32_t encode_u_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_U(a->imm, a->rd, def->opcode);
+}
 
-        case TYPE_J:
-            return encode_J(a->imm, a->rd, def->opcode);
+uint32_t encode_j_type(const instr_def_t *def, const void *args) {
+    const instr_args_t *a = (const instr_args_t *)args;
+    return encode_J(a->imm, a->rd, def->opcode);
+}
 
-        default:
-            return 0;
+// ==================== PARSING FUNCTIONS ====================
+// One parser per operand syntax, selected by the generated tables.
+// Each returns non-zero on success.
+
+// rd, rs1, rs2
+int parse_r_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    (void)def;
+    return sscanf(line,"x%d, x%d, x%d", &a->rd, &a->rs1, &a->rs2);
+}
+
+// Unary R-Type: clz rd, rs1
+int parse_r1_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    (void)def;
+    return sscanf(line,"x%d, x%d", &a->rd, &a->rs1) == 2;
+}
+
+// ALU immediate & JALR: rd, rs1, imm
+int parse_i_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char anchor[64];
+    (void)def;
+
+    if (sscanf(line, "x%d, x%d, %%pcrel_lo(%63[^)])", &a->rd, &a->rs1, anchor) == 3)
+        return resolve_pcrel_lo(anchor, RELOC_PCREL_LO12_I, a);
+    return sscanf(line,"x%d, x%d, %i", &a->rd, &a->rs1, &a->imm);
+}
+
+// Load instructions: rd, offset(rs1)
+int parse_load(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char anchor[64];
+    (void)def;
+
+    if (sscanf(line, "x%d, %%pcrel_lo(%63[^)])(x%d)", &a->rd, anchor, &a->rs1) == 3)
+        return resolve_pcrel_lo(anchor, RELOC_PCREL_LO12_I, a);
+    return sscanf(line,"x%d, %i(x%d)",&a->rd, &a->imm, &a->rs1);
+}
+
+// Shift/rotate/bit immediates: rd, rs1, shamt
+int parse_i7_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+
+    // 0..63 needs a 6-bit field (shamtd) and an RV64 image; *w forms and RV32 stop at 31
+    int bits = (get_xlen() == 64) ? def->shamt_bits : 5;
+
+    if (sscanf(line,"x%d, x%d, %i", &a->rd, &a->rs1, &a->shamt) != 3)
+        return 0;
+    if (a->shamt < 0 || a->shamt >= (1 << bits)) {
+        diag_line("Shift amount %d out of range 0..%d\n", a->shamt, (1 << bits) - 1);
+        return 0;
     }
+    return 1;
 }
 
-// ==================== PARSING FUNCTIONS ====================
-int (*parser)(const instr_def_t *, const char *, void *);
-static int parse_dispatch(const instr_def_t *def, const char *line, void *args)
-{
+// rs2, offset(rs1)
+int parse_s_type(const instr_def_t *def, const char *line, void *args) {
     instr_args_t *a = (instr_args_t *)args;
+    char anchor[64];
+    (void)def;
+
+    if (sscanf(line, "x%d, %%pcrel_lo(%63[^)])(x%d)", &a->rs2, anchor, &a->rs1) == 3)
+        return resolve_pcrel_lo(anchor, RELOC_PCREL_LO12_S, a);
+    return sscanf(line,"x%d, %i(x%d)", &a->rs2, &a->imm, &a->rs1);
+}
 
-    switch (def->format) {
-
-        case TYPE_R:
-            // Normal R-Type
-            return sscanf(line,"x%d, x%d, x%d", &a->rd, &a->rs1, &a->rs2);
-
-        case TYPE_I:{
-            if (def->opcode == 0x03) { /* Load instructions */
-                /* Format: rd, offset(rs1) */
-                return sscanf(line,"x%d, %i(x%d)",&a->rd, &a->imm, &a->rs1);
-            } else if (def->opcode == 0x13 || def->opcode == 0x1B || def->opcode == 0x67) { /* ALU immediate & JALR */
-                /* Format: rd, rs1, imm */
-                return sscanf(line,"x%d, x%d, %i", &a->rd, &a->rs1, &a->imm);
-            }
-            // ZICSR //
-            else if (def->opcode == 0x73 && def->funct3 == 0) {   // SYSTEM
-                // ecall / ebreak / mret
-                a->rd  = 0;           // always zero
-                a->rs1 = 0;           // always zero
-                a->imm = def->funct12; // imm = funct12
-                return 1;
-                }
-            else if (def->funct3 == 1 || def->funct3 == 2 || def->funct3 == 3) {
-                    char csr[32];
-                    // CSR register form
-                    // csrrw rd,offset,rs1
-                    int ret = sscanf(line,"x%d, %31[^,], x%d", &a->rd, csr, &a->rs1);
-                        if (ret == 3) {
-                            if (is_number(csr)) {
-                                a->imm = parse_number(csr);
-                        } else if (!lookup_csr(csr, (uint16_t*)&a->imm)) {
-                                error("Unknown CSR");
-                            }
-                        }
-                    return ret;
-                }
-            else if (def->funct3 == 5 || def->funct3 == 6 || def->funct3 == 7) {
-                    char csr[32];
-                    // CSR immediate form
-                    // csrrwi rd,offset,uimm                          //uimm
-                    int ret = sscanf(line,"x%d, %31[^,], %d", &a->rd, csr, &a->rs1);
-                    if (ret == 3) {
-                        if (is_number(csr)) {
-                            a->imm = parse_number(csr);
-                    } else if (!lookup_csr(csr, (uint16_t*)&a->imm)) {
-                            error("Unknown CSR");
-                    }
-                }
-        return ret;
-                }
-            }
-
-        case TYPE_I7:
-            return sscanf(line,"x%d, x%d, %i", &a->rd, &a->rs1, &a->shamt);
-
-        case TYPE_S:
-            return sscanf(line,"x%d, %i(x%d)", &a->rs2, &a->imm, &a->rs1);
-
-        case TYPE_B: {
-            char label[64];
-
-            if (sscanf(line,"x%d, x%d, %i",&a->rs1, &a->rs2, &a->imm) == 3)
-                return 1;
-
-            if (sscanf(line,"x%d, x%d, %63s",&a->rs1, &a->rs2, label) == 3) {
-
-            uint32_t target;
-
-            if (!find_label(label, &target)) {
-                printf("Unknown label: %s\n", label);
-                return 0;
-            }
-
-            a->imm = (int32_t)target - (int32_t)a->current_pc;
-
-            if (a->imm % 2 != 0) {
-                printf("Unaligned branch target\n");
-                return 0;
-            }
-
-            if (a->imm < -4096 || a->imm > 4094) {
-                printf("Branch offset out of range\n");
-                return 0;
-            }
+// rs1, rs2, offset | label
+int parse_b_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char label[64];
+    uint32_t target;
+    (void)def;
 
+    if (sscanf(line,"x%d, x%d, %i",&a->rs1, &a->rs2, &a->imm) == 3)
+        return 1;
+
+    if (sscanf(line,"x%d, x%d, %63s",&a->rs1, &a->rs2, label) != 3)
+        return 0;
+
+    if (!find_label(label, &target)) {
+        // Defined in another file: the linker patches the offset
+        if (defer_label(label, RELOC_B, a->current_pc)) {
+            a->imm = 0;
             return 1;
         }
+        diag_line("Unknown label: %s\n", label);
+        return 0;
+    }
 
+    a->imm = (int32_t)target - (int32_t)a->current_pc;
+
+    if (a->imm % 2 != 0) {
+        diag_line("Unaligned branch target\n");
         return 0;
-        }
+    }
 
-        case TYPE_U:
-            return sscanf(line, "x%d, %i", &a->rd, &a->imm);
+    if (a->imm < -4096 || a->imm > 4094) {
+        diag_line("Branch offset out of range\n");
+        return 0;
+    }
 
-        case TYPE_J: {
-            char label_name[64];
+    return 1;
+}
 
-            // Immediate number
-            if (sscanf(line, "x%d, %i", &a->rd, &a->imm) == 2)
-                return 1;
+// rd, imm20 | (auipc) label | (auipc) %pcrel_hi(label)
+int parse_u_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char label[64];
+    uint32_t target;
 
-            // Label target
-            if (sscanf(line, "x%d, %63s", &a->rd, label_name) == 2) {
-                uint32_t target_addr;
-                if (!find_label(label_name, &target_addr)) {
-                    printf("Unknown label: %s\n", label_name);
-                        return 0;
-                    }
+    if (sscanf(line, "x%d, %i", &a->rd, &a->imm) == 2)
+        return 2;
 
-        a->imm = (int32_t)target_addr - (int32_t)a->current_pc;
+    // auipc rd, label -> upper 20 bits of the pc-relative offset
+    if (def->opcode != 0x17)
+        return 0;
+    if (sscanf(line, "x%d, %%pcrel_hi(%63[^)])", &a->rd, label) != 2 &&
+        sscanf(line, "x%d, %63s", &a->rd, label) != 2)
+        return 0;
 
-        // Check alignment
-        if (a->imm % 2 != 0) {
-            printf("Unaligned jump target\n");
-            return 0;
+    if (!find_label(label, &target)) {
+        if (defer_label(label, RELOC_PCREL_HI20, a->current_pc)) {
+            record_pcrel_hi(a->current_pc, label);
+            a->imm = 0;
+            return 1;
         }
+        diag_line("Unknown label: %s\n", label);
+        return 0;
+    }
 
-        if (a->imm < -1048576 || a->imm > 1048574) {
-            printf("Jump offset out of range\n");
-            return 0;
-        }
+    record_pcrel_hi(a->current_pc, label);
+    a->imm = pcrel_hi20((int32_t)target - (int32_t)a->current_pc);
+    return 1;
+}
+
+// rd, offset | label
+int parse_j_type(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char label_name[64];
+    uint32_t target_addr;
+    (void)def;
 
+    // Immediate number
+    if (sscanf(line, "x%d, %i", &a->rd, &a->imm) == 2)
         return 1;
-    }
 
-    return 0;
-}
+    // Label target
+    if (sscanf(line, "x%d, %63s", &a->rd, label_name) != 2)
+        return 0;
 
-        default:
-            return 0;
+    if (!find_label(label_name, &target_addr)) {
+        if (defer_label(label_name, RELOC_J, a->current_pc)) {
+            a->imm = 0;
+            return 1;
+        }
+        diag_line("Unknown label: %s\n", label_name);
+        return 0;
     }
-}
 
-// ==================== INSTRUCTION TABLE ====================
-
-// RV32I Base Instructions (Complete set)
-instr_def_t rv32i_instructions[] = {
-     /* ---------------- R-Type ---------------- */
-    {"add",  TYPE_R, 0x33, 0b000, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"sub",  TYPE_R, 0x33, 0b000, 0x20, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"sll",  TYPE_R, 0x33, 0b001, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift left logical
-    {"slt",  TYPE_R, 0x33, 0b010, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // set less than
-    {"sltu",  TYPE_R, 0x33, 0b011, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // set less than unsigned
-    {"xor",  TYPE_R, 0x33, 0b100, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"srl",  TYPE_R, 0x33, 0b101, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift right logical
-    {"sra",  TYPE_R, 0x33, 0b101, 0x20, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift right arithmetic
-    {"or",  TYPE_R, 0x33, 0b110, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"and",  TYPE_R, 0x33, 0b111, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-
-     /* ---------------- I-Type ---------------- */
-    {"lb",   TYPE_I, 0x03, 0b000, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load byte
-    {"lh",   TYPE_I, 0x03, 0b001, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load half
-    {"lw",   TYPE_I, 0x03, 0b010, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load word
-    {"lbu",   TYPE_I, 0x03, 0b100, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load byte unsigned
-    {"lhu",   TYPE_I, 0x03, 0b101, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load half unsigned
-
-    {"addi", TYPE_I, 0x13, 0b000, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"slti", TYPE_I, 0x13, 0b010, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // set less than immediate
-    {"sltiu", TYPE_I, 0x13, 0b011, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // set less than immediate unsigned
-    {"xori", TYPE_I, 0x13, 0b100, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"ori", TYPE_I, 0x13, 0b110, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-    {"andi", TYPE_I, 0x13, 0b111, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch},
-
-    {"jalr", TYPE_I, 0x67, 0b000, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // jump and link register
-
-    /* ---------------- I7-Type ---------------- */
-    {"slli", TYPE_I7, 0x13, 0b001, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift left logical immediate
-    {"srli", TYPE_I7, 0x13, 0b101, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift right logical immediate
-    {"srai", TYPE_I7, 0x13, 0b101, 0b0100000, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // shift right arithmetic immediate
-
-     /* ---------------- S-Type ---------------- */
-    {"sb",   TYPE_S, 0x23, 0x0, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // store byte
-    {"sh",   TYPE_S, 0x23, 0x1, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // store half
-    {"sw",   TYPE_S, 0x23, 0x2, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // store word
-
-    /* ---------------- B-Type ---------------- */
-    {"beq",  TYPE_B, 0x63, 0x0, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if =
-    {"bne",  TYPE_B, 0x63, 0x1, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if !=
-    {"blt",  TYPE_B, 0x63, 0x4, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if <
-    {"bge",  TYPE_B, 0x63, 0x5, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if >=
-    {"bltu",  TYPE_B, 0x63, 0x6, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if < unsigned
-    {"bgeu",  TYPE_B, 0x63, 0x7, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // branch if >= unsigned
-
-    /* ---------------- U-Type ---------------- */
-    {"lui",  TYPE_U, 0x37, 0x0, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // load upper immediate
-    {"auipc",  TYPE_U, 0x17, 0x0, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, // add upper immediate to PC
-
-    /* ---------------- J-Type ---------------- */
-    {"jal",  TYPE_J, 0x6F, 0x0, 0x00, 0, ISA_RV32I, encode_dispatch, parse_dispatch}, //  jump and link
-};
+    a->imm = (int32_t)target_addr - (int32_t)a->current_pc;
+
+    // Check alignment
+    if (a->imm % 2 != 0) {
+        diag_line("Unaligned jump target\n");
+        return 0;
+    }
 
-// RV64I Base Instructions (Complete set)
-instr_def_t rv64i_instructions[] = {
-    /* ---------------- I-Type ---------------- */
-    {"ld",   TYPE_I, 0x03, 0x3, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Load double
-    {"lwu",   TYPE_I, 0x03, 0x6, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Load word unsigned
-    {"addiw", TYPE_I, 0x1B, 0x0, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Add immediate word
+    if (a->imm < -1048576 || a->imm > 1048574) {
+        diag_line("Jump offset out of range\n");
+        return 0;
+    }
 
-    /* ---------------- I7-Type ---------------- */
-    {"slliw", TYPE_I7,0x1B, 0x1, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Shift left logical word
-    {"srliw", TYPE_I7,0x1B, 0x5, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Shift right logical immediate word
-    {"sraiw", TYPE_I7,0x1B, 0x5, 0x20, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Shift right arith. immediate word
+    return 1;
+}
 
-    /* ---------------- S-Type ---------------- */
-    {"sd",   TYPE_S, 0x23, 0x3, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // Store double
+// CSR register form: csrrw rd, csr, rs1
+int parse_csr_reg(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char csr[32];
 
-    /* ---------------- R-Type ---------------- */
-    {"addw", TYPE_R, 0x3B, 0x0, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch},
-    {"subw", TYPE_R, 0x3B, 0x0, 0x20, 0, ISA_RV64I, encode_dispatch, parse_dispatch},
-    {"sllw", TYPE_R, 0x3B, 0x1, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // shift left logical word
-    {"srlw", TYPE_R, 0x3B, 0x5, 0x00, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // shift right logical word
-    {"sraw", TYPE_R, 0x3B, 0x5, 0x20, 0, ISA_RV64I, encode_dispatch, parse_dispatch}, // shift right arithmetic word
+    int ret = sscanf(line,"x%d, %31[^,], x%d", &a->rd, csr, &a->rs1);
+    if (ret == 3) {
+        // csrrw always writes; csrrs/csrrc only with rs1 != x0
+        int writes = def->funct3 == 1 || a->rs1 != 0;
+        if (!resolve_csr(csr, writes, &a->imm))
+            return 0;
+    }
+    return ret;
+}
 
+// CSR immediate form: csrrwi rd, csr, uimm
+int parse_csr_imm(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    char csr[32];
 
-};
-// M Extension
-instr_def_t m_instructions[] = {
-
-    /* ----------- R-Type (RV32 + RV64) ----------- */
-    {"mul",    TYPE_R, 0x33, 0b000, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"mulh",   TYPE_R, 0x33, 0b001, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"mulhsu", TYPE_R, 0x33, 0b010, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"mulhu",  TYPE_R, 0x33, 0b011, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"div",    TYPE_R, 0x33, 0b100, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"divu",   TYPE_R, 0x33, 0b101, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"rem",    TYPE_R, 0x33, 0b110, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"remu",   TYPE_R, 0x33, 0b111, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-
-    /* ----------- RV64 Only (Word ops) ----------- */
-    {"mulw",   TYPE_R, 0x3B, 0b000, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"divw",   TYPE_R, 0x3B, 0b100, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"divuw",  TYPE_R, 0x3B, 0b101, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"remw",   TYPE_R, 0x3B, 0b110, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-    {"remuw",  TYPE_R, 0x3B, 0b111, 0x01, 0, ISA_EXT_M, encode_dispatch, parse_dispatch},
-};
+    int ret = sscanf(line,"x%d, %31[^,], %d", &a->rd, csr, &a->rs1);
+    if (ret == 3) {
+        int writes = def->funct3 == 5 || a->rs1 != 0;
+        if (!resolve_csr(csr, writes, &a->imm))
+            return 0;
+    }
+    return ret;
+}
 
-// Zicsr Extension (not complete)
-instr_def_t zicsr_instructions[] = {
-    // ecall / ebreak / mret
-    {"ecall",  TYPE_I, 0x73, 0x0, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"ebreak", TYPE_I, 0x73, 0x0, 0x00, 0b000000000001, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"mret",   TYPE_I, 0x73, 0x0, 0x18, 0b001100000010, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    // CSR register form
-    {"csrrw",   TYPE_I, 0x73, 0x1, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"csrrs",   TYPE_I, 0x73, 0x2, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"csrrc",   TYPE_I, 0x73, 0x3, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    // CSR immediate form
-    {"csrrwi",   TYPE_I, 0x73, 0x5, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"csrrsi",   TYPE_I, 0x73, 0x6, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-    {"csrrci",   TYPE_I, 0x73, 0x7, 0x00, 0, ISA_EXT_ZICSR, encode_dispatch, parse_dispatch},
-};
+// ecall / ebreak / mret: no operands, imm = funct12
+int parse_system(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    (void)line;
+    a->rd  = 0;
+    a->rs1 = 0;
+    a->imm = def->funct12;
+    return 1;
+}
 
-size_t num_rv32i_instructions = sizeof(rv32i_instructions) / sizeof(rv32i_instructions[0]);
-size_t num_rv64i_instructions = sizeof(rv64i_instructions)/sizeof(rv64i_instructions[0]);
-size_t num_m_instructions = sizeof(m_instructions)/sizeof(m_instructions[0]);
-size_t num_zicsr_instructions = sizeof(zicsr_instructions)/sizeof(zicsr_instructions[0]);
-#define NUM_RV32I_INSTRUCTIONS (sizeof(rv32i_instructions) / sizeof(rv32i_instructions[0]))
-#define NUM_RV64I_INSTRUCTIONS (sizeof(rv64i_instructions) / sizeof(rv64i_instructions[0]))
-#define NUM_M_INSTRUCTIONS (sizeof(m_instructions)/sizeof(m_instructions[0]))
-#define NUM_ZICSR_INSTRUCTIONS (sizeof(zicsr_instructions)/sizeof(zicsr_instructions[0]))
+// rdcycle/rdtime/rdinstret rd = csrrs rd, <funct12>, x0
+int parse_counter(const instr_def_t *def, const char *line, void *args) {
+    instr_args_t *a = (instr_args_t *)args;
+    a->rs1 = 0;
+    a->imm = def->funct12;
+    return sscanf(line,"x%d", &a->rd);
+}
@@ -3,21 +3,36 @@
 
 #include "instruction_defs.h"
 #include "instruction_args.h"
+#include "instr_tables.h"
+#include <stddef.h>
+#include <stdint.h>
 
-// Declare the instruction table and its size
-// Base ISA
-extern instr_def_t rv32i_instructions[];
-extern size_t num_rv32i_instructions;
+// The instruction tables, the mnemonic index and the decode table are
+// generated from opcodes/ by gen_tables (see instr_tables.h).
 
-extern instr_def_t rv64i_instructions[];
-extern size_t num_rv64i_instructions;
+// Format-specialized encoders referenced by the generated tables
+uint32_t encode_r_type(const instr_def_t *def, const void *args);
+uint32_t encode_r1_type(const instr_def_t *def, const void *args);
+uint32_t encode_i_type(const instr_def_t *def, const void *args);
+uint32_t encode_i7_type(const instr_def_t *def, const void *args);
+uint32_t encode_s_type(const instr_def_t *def, const void *args);
+uint32_t encode_b_type(const instr_def_t *def, const void *args);
+uint32_t encode_u_type(const instr_def_t *def, const void *args);
+uint32_t encode_j_type(const instr_def_t *def, const void *args);
 
-// M extension
-extern instr_def_t m_instructions[];
-extern size_t num_m_instructions;
-
-// Zicsr extension
-extern instr_def_t zicsr_instructions[];
-extern size_t num_zicsr_instructions;
+// Operand parsers, one per assembly syntax
+int parse_r_type(const instr_def_t *def, const char *line, void *args);
+int parse_r1_type(const instr_def_t *def, const char *line, void *args);
+int parse_i_type(const instr_def_t *def, const char *line, void *args);
+int parse_load(const instr_def_t *def, const char *line, void *args);
+int parse_i7_type(const instr_def_t *def, const char *line, void *args);
+int parse_s_type(const instr_def_t *def, const char *line, void *args);
+int parse_b_type(const instr_def_t *def, const char *line, void *args);
+int parse_u_type(const instr_def_t *def, const char *line, void *args);
+int parse_j_type(const instr_def_t *def, const char *line, void *args);
+int parse_csr_reg(const instr_def_t *def, const char *line, void *args);
+int parse_csr_imm(const instr_def_t *def, const char *line, void *args);
+int parse_system(const instr_def_t *def, const char *line, void *args);
+int parse_counter(const instr_def_t *def, const char *line, void *args);
 
 #endif // RISCV_INSTRUCTIONS_H_INCLUDED
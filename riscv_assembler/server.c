@@ -0,0 +1,263 @@
+// server.c
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "server.h"
+#include "assembler.h"
+
+#if defined(_WIN32)
+
+int serve(const char *socket_path, int xlen) {
+    (void)socket_path;
+    (void)xlen;
+    printf("--serve is not supported on this platform\n");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define CLIENT_TIMEOUT_SEC 10
+
+/* ---------------------- Types ---------------------- */
+typedef struct {
+    uint32_t *words;
+    size_t count;
+    size_t capacity;
+    int out_of_memory;
+} word_buf_t;
+
+typedef struct {
+    int listen_fd;
+    int xlen;               // default for requests without an XLEN line
+} server_t;
+
+/* ---------------------- Helpers ---------------------- */
+static void collect_word(void *ctx, const instr_def_t *def, const char *line, uint32_t machine) {
+    word_buf_t *buf = (word_buf_t *)ctx;
+    (void)def;
+    (void)line;
+
+    if (buf->out_of_memory)
+        return;
+    if (buf->count == buf->capacity) {
+        size_t new_capacity = buf->capacity ? buf->capacity * 2 : 256;
+        uint32_t *grown = realloc(buf->words, new_capacity * sizeof(*buf->words));
+        if (!grown) { buf->out_of_memory = 1; return; }
+        buf->words = grown;
+        buf->capacity = new_capacity;
+    }
+    buf->words[buf->count++] = machine;
+}
+
+// Read the whole request until the client half-closes
+static char *read_request(int fd, size_t *len) {
+    size_t capacity = 4096, used = 0;
+    char *buf = malloc(capacity);
+    if (!buf) return NULL;
+
+    for (;;) {
+        if (used == capacity) {
+            if (capacity >= SERVER_MAX_REQUEST) { free(buf); return NULL; }
+            char *grown = realloc(buf, capacity * 2);
+            if (!grown) { free(buf); return NULL; }
+            buf = grown;
+            capacity *= 2;
+        }
+        ssize_t n = read(fd, buf + used, capacity - used);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) { free(buf); return NULL; }
+        if (n == 0) break;
+        used += (size_t)n;
+    }
+
+    *len = used;
+    return buf;
+}
+
+// Gives up when the client went away or has not read for CLIENT_TIMEOUT_SEC
+// (SO_SNDTIMEO makes write() fail with EAGAIN); the caller then closes.
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+/* ---------------------- Request handling ---------------------- */
+// An optional first line "XLEN 32" or "XLEN 64" selects the request's XLEN
+static int request_xlen(const char **src, size_t *len, int xlen) {
+    static const char *const headers[] = {"XLEN 32\n", "XLEN 64\n"};
+
+    for (int i = 0; i < 2; i++) {
+        size_t n = strlen(headers[i]);
+        if (*len >= n && memcmp(*src, headers[i], n) == 0) {
+            *src += n;
+            *len -= n;
+            return i ? 64 : 32;
+        }
+    }
+    return xlen;
+}
+
+static void handle_client(int fd, int default_xlen) {
+    size_t src_len = 0;
+    char *src = read_request(fd, &src_len);
+    if (!src) {
+        static const char msg[] = "ERROR 0 1\nRequest too large or unreadable\n";
+        write_all(fd, msg, sizeof(msg) - 1);
+        close(fd);
+        return;
+    }
+
+    word_buf_t out = {0};
+    char *diag_buf = NULL;
+    size_t diag_len = 0;
+    int result = 0;
+    const char *body = src;
+    size_t body_len = src_len;
+    int xlen = request_xlen(&body, &body_len, default_xlen);
+
+    if (body_len > 0) {
+        FILE *in = fmemopen((void *)body, body_len, "r");
+        FILE *diags = open_memstream(&diag_buf, &diag_len);
+        if (in && diags) {
+            set_diag_stream(diags);
+            set_xlen(xlen);
+            result = assemble_stream(in, "<input>", collect_word, &out);
+            set_diag_stream(NULL);
+        } else {
+            result = -1;
+        }
+        if (in) fclose(in);
+        if (diags) fclose(diags);
+    }
+
+    int num_diags = 0;
+    for (size_t i = 0; i < diag_len; i++)
+        if (diag_buf[i] == '\n') num_diags++;
+
+    char *reply = NULL;
+    size_t reply_len = 0;
+    FILE *rs = open_memstream(&reply, &reply_len);
+    if (rs) {
+        int ok = (result == 0 && !out.out_of_memory);
+        fprintf(rs, "%s %zu %d\n", ok ? "OK" : "ERROR", out.count, num_diags);
+        for (size_t i = 0; i < out.count; i++)
+            fprintf(rs, "%08X\n", out.words[i]);
+        if (diag_len)
+            fwrite(diag_buf, 1, diag_len, rs);
+        fclose(rs);
+        write_all(fd, reply, reply_len);
+    }
+
+    free(reply);
+    free(diag_buf);
+    free(out.words);
+    free(src);
+    close(fd);
+}
+
+/* ---------------------- Worker pool ---------------------- */
+// Every worker blocks in accept() on the shared listening socket
+static void *worker_main(void *arg) {
+    const server_t *server = (const server_t *)arg;
+    int listen_fd = server->listen_fd;
+    struct timeval timeout = {CLIENT_TIMEOUT_SEC, 0};
+
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("accept");
+            break;
+        }
+        // A client that stops sending or stops reading must not hold the worker
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handle_client(fd, server->xlen);
+    }
+    return NULL;
+}
+
+int serve(const char *socket_path, int xlen) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        printf("Socket path too long: %s\n", socket_path);
+        return 1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    // Replace a socket left over from an earlier run, never anything else
+    struct stat st;
+    if (lstat(socket_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            printf("Cannot serve on %s: path exists and is not a socket\n", socket_path);
+            return 1;
+        }
+        unlink(socket_path);
+    }
+
+    signal(SIGPIPE, SIG_IGN);  // clients may disconnect before the reply
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) { perror("socket"); return 1; }
+
+    mode_t old_mask = umask(077);  // owner-only socket
+    int bound = bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+    if (bound < 0 || listen(listen_fd, 128) < 0) {
+        perror("Cannot listen on socket");
+        close(listen_fd);
+        return 1;
+    }
+
+    server_t server = {listen_fd, xlen};
+    long num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers < 1) num_workers = 1;
+    if (num_workers > SERVER_MAX_WORKERS) num_workers = SERVER_MAX_WORKERS;
+
+    pthread_t workers[SERVER_MAX_WORKERS];
+    long started = 0;
+    for (; started < num_workers; started++)
+        if (pthread_create(&workers[started], NULL, worker_main, &server) != 0)
+            break;
+
+    if (started == 0) {
+        printf("Cannot start worker threads\n");
+        close(listen_fd);
+        unlink(socket_path);
+        return 1;
+    }
+
+    printf("Serving on %s with %ld workers\n", socket_path, started);
+    fflush(stdout);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+
+    close(listen_fd);
+    unlink(socket_path);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+// Upper bound on the source text accepted per request
+#ifndef SERVER_MAX_REQUEST
+#define SERVER_MAX_REQUEST (16u * 1024u * 1024u)
+#endif
+
+#define SERVER_MAX_WORKERS 64
+
+// Serve assembly requests on a local Unix domain socket until killed.
+// A client sends source text and then shuts down its write side; an optional
+// first line "XLEN 32" or "XLEN 64" overrides the server's default xlen. The reply is
+//   OK|ERROR <num_words> <num_diagnostics>\n
+// followed by one %08X word per line and then the diagnostic lines.
+// Connections are handled by a pool of worker threads (one per CPU).
+int serve(const char *socket_path, int xlen);
+
+#endif // SERVER_H
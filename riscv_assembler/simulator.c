@@ -0,0 +1,734 @@
+// simulator.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "simulator.h"
+#include "instruction_defs.h"
+#include "riscv_instructions.h"
+
+/* ---------------------- Handler list ---------------------- */
+// Every handler the dispatch loop knows about. The W forms double as the
+// RV32 handlers: on RV32 registers are kept sign-extended from 32 bits,
+// so e.g. RV32 "add" behaves exactly like RV64 "addw".
+#define SIM_OPS(X) \
+    X(ADD)   X(SUB)   X(SLL)   X(SLT)   X(SLTU)  X(XOR)   X(SRL)   X(SRA)   X(OR)    X(AND)  \
+    X(ADDI)  X(SLTI)  X(SLTIU) X(XORI)  X(ORI)   X(ANDI)  X(SLLI)  X(SRLI)  X(SRAI)          \
+    X(LB)    X(LH)    X(LW)    X(LBU)   X(LHU)   X(LD)    X(LWU)                             \
+    X(SB)    X(SH)    X(SW)    X(SD)                                                         \
+    X(BEQ)   X(BNE)   X(BLT)   X(BGE)   X(BLTU)  X(BGEU)                                     \
+    X(LUI)   X(AUIPC) X(JAL)   X(JALR)                                                       \
+    X(ADDW)  X(SUBW)  X(SLLW)  X(SRLW)  X(SRAW)  X(ADDIW) X(SLLIW) X(SRLIW) X(SRAIW)         \
+    X(MUL)   X(MULH)  X(MULHSU) X(MULHU) X(DIV)  X(DIVU)  X(REM)   X(REMU)                   \
+    X(MULW)  X(DIVW)  X(DIVUW) X(REMW)  X(REMUW)                                             \
+    X(MULH32) X(MULHSU32) X(MULHU32)                                                         \
+    X(SH1ADD) X(SH2ADD) X(SH3ADD) X(SH1ADD32) X(SH2ADD32) X(SH3ADD32)                        \
+    X(ADDUW) X(SH1ADDUW) X(SH2ADDUW) X(SH3ADDUW) X(SLLIUW)                                   \
+    X(ANDN)  X(ORN)   X(XNOR)  X(MIN)   X(MINU)  X(MAX)   X(MAXU)                            \
+    X(ROL)   X(ROR)   X(RORI)  X(ROLW)  X(RORW)  X(RORIW)                                    \
+    X(CLZ)   X(CTZ)   X(CPOP)  X(CLZW)  X(CTZW)  X(CPOPW)                                    \
+    X(SEXTB) X(SEXTH) X(ZEXTH) X(ORCB)  X(REV8)  X(REV8_32)                                  \
+    X(BCLR)  X(BEXT)  X(BINV)  X(BSET)  X(BCLRI) X(BEXTI) X(BINVI) X(BSETI)                  \
+    X(BCLR32) X(BEXT32) X(BINV32) X(BSET32) X(BCLRI32) X(BINVI32) X(BSETI32)                 \
+    X(CZEROEQZ) X(CZERONEZ)                                                                  \
+    X(ECALL) X(EBREAK) X(NOP)  X(HALT)  X(BADPC) X(ILLEGAL)
+
+typedef enum {
+#define X(name) OP_##name,
+    SIM_OPS(X)
+#undef X
+    NUM_OPS
+} sim_op_t;
+
+/* ---------------------- Types ---------------------- */
+// One predecoded instruction. For branches and jal, imm holds the
+// target index into the predecoded array instead of a byte offset.
+typedef struct {
+    uint8_t op;
+    uint8_t rd, rs1, rs2;
+    int32_t imm;
+} sim_insn_t;
+
+// Maps a mnemonic from the instruction tables to its RV64 and RV32 handler
+typedef struct {
+    const char *mnemonic;
+    uint8_t op64;
+    uint8_t op32;
+} sim_op_map_t;
+
+static const sim_op_map_t op_map[] = {
+    {"add",    OP_ADD,    OP_ADDW},
+    {"sub",    OP_SUB,    OP_SUBW},
+    {"sll",    OP_SLL,    OP_SLLW},
+    {"slt",    OP_SLT,    OP_SLT},
+    {"sltu",   OP_SLTU,   OP_SLTU},
+    {"xor",    OP_XOR,    OP_XOR},
+    {"srl",    OP_SRL,    OP_SRLW},
+    {"sra",    OP_SRA,    OP_SRAW},
+    {"or",     OP_OR,     OP_OR},
+    {"and",    OP_AND,    OP_AND},
+
+    {"addi",   OP_ADDI,   OP_ADDIW},
+    {"slti",   OP_SLTI,   OP_SLTI},
+    {"sltiu",  OP_SLTIU,  OP_SLTIU},
+    {"xori",   OP_XORI,   OP_XORI},
+    {"ori",    OP_ORI,    OP_ORI},
+    {"andi",   OP_ANDI,   OP_ANDI},
+    {"slli",   OP_SLLI,   OP_SLLIW},
+    {"srli",   OP_SRLI,   OP_SRLIW},
+    {"srai",   OP_SRAI,   OP_SRAIW},
+
+    {"lb",     OP_LB,     OP_LB},
+    {"lh",     OP_LH,     OP_LH},
+    {"lw",     OP_LW,     OP_LW},
+    {"lbu",    OP_LBU,    OP_LBU},
+    {"lhu",    OP_LHU,    OP_LHU},
+    {"ld",     OP_LD,     OP_LD},
+    {"lwu",    OP_LWU,    OP_LWU},
+
+    {"sb",     OP_SB,     OP_SB},
+    {"sh",     OP_SH,     OP_SH},
+    {"sw",     OP_SW,     OP_SW},
+    {"sd",     OP_SD,     OP_SD},
+
+    {"beq",    OP_BEQ,    OP_BEQ},
+    {"bne",    OP_BNE,    OP_BNE},
+    {"blt",    OP_BLT,    OP_BLT},
+    {"bge",    OP_BGE,    OP_BGE},
+    {"bltu",   OP_BLTU,   OP_BLTU},
+    {"bgeu",   OP_BGEU,   OP_BGEU},
+
+    {"lui",    OP_LUI,    OP_LUI},
+    {"auipc",  OP_AUIPC,  OP_AUIPC},
+    {"jal",    OP_JAL,    OP_JAL},
+    {"jalr",   OP_JALR,   OP_JALR},
+
+    {"addw",   OP_ADDW,   OP_ADDW},
+    {"subw",   OP_SUBW,   OP_SUBW},
+    {"sllw",   OP_SLLW,   OP_SLLW},
+    {"srlw",   OP_SRLW,   OP_SRLW},
+    {"sraw",   OP_SRAW,   OP_SRAW},
+    {"addiw",  OP_ADDIW,  OP_ADDIW},
+    {"slliw",  OP_SLLIW,  OP_SLLIW},
+    {"srliw",  OP_SRLIW,  OP_SRLIW},
+    {"sraiw",  OP_SRAIW,  OP_SRAIW},
+
+    {"mul",    OP_MUL,    OP_MULW},
+    {"mulh",   OP_MULH,   OP_MULH32},
+    {"mulhsu", OP_MULHSU, OP_MULHSU32},
+    {"mulhu",  OP_MULHU,  OP_MULHU32},
+    {"div",    OP_DIV,    OP_DIVW},
+    {"divu",   OP_DIVU,   OP_DIVUW},
+    {"rem",    OP_REM,    OP_REMW},
+    {"remu",   OP_REMU,   OP_REMUW},
+    {"mulw",   OP_MULW,   OP_MULW},
+    {"divw",   OP_DIVW,   OP_DIVW},
+    {"divuw",  OP_DIVUW,  OP_DIVUW},
+    {"remw",   OP_REMW,   OP_REMW},
+    {"remuw",  OP_REMUW,  OP_REMUW},
+
+    {"sh1add",    OP_SH1ADD,   OP_SH1ADD32},
+    {"sh2add",    OP_SH2ADD,   OP_SH2ADD32},
+    {"sh3add",    OP_SH3ADD,   OP_SH3ADD32},
+    {"add.uw",    OP_ADDUW,    OP_ADDUW},
+    {"sh1add.uw", OP_SH1ADDUW, OP_SH1ADDUW},
+    {"sh2add.uw", OP_SH2ADDUW, OP_SH2ADDUW},
+    {"sh3add.uw", OP_SH3ADDUW, OP_SH3ADDUW},
+    {"slli.uw",   OP_SLLIUW,   OP_SLLIUW},
+
+    {"andn",   OP_ANDN,   OP_ANDN},
+    {"orn",    OP_ORN,    OP_ORN},
+    {"xnor",   OP_XNOR,   OP_XNOR},
+    {"min",    OP_MIN,    OP_MIN},
+    {"minu",   OP_MINU,   OP_MINU},
+    {"max",    OP_MAX,    OP_MAX},
+    {"maxu",   OP_MAXU,   OP_MAXU},
+    {"rol",    OP_ROL,    OP_ROLW},
+    {"ror",    OP_ROR,    OP_RORW},
+    {"rori",   OP_RORI,   OP_RORIW},
+    {"clz",    OP_CLZ,    OP_CLZW},
+    {"ctz",    OP_CTZ,    OP_CTZW},
+    {"cpop",   OP_CPOP,   OP_CPOPW},
+    {"sext.b", OP_SEXTB,  OP_SEXTB},
+    {"sext.h", OP_SEXTH,  OP_SEXTH},
+    {"zext.h", OP_ZEXTH,  OP_ZEXTH},
+    {"orc.b",  OP_ORCB,   OP_ORCB},
+    {"rev8",   OP_REV8,   OP_REV8_32},
+    {"clzw",   OP_CLZW,   OP_CLZW},
+    {"ctzw",   OP_CTZW,   OP_CTZW},
+    {"cpopw",  OP_CPOPW,  OP_CPOPW},
+    {"rolw",   OP_ROLW,   OP_ROLW},
+    {"rorw",   OP_RORW,   OP_RORW},
+    {"roriw",  OP_RORIW,  OP_RORIW},
+
+    {"bclr",   OP_BCLR,   OP_BCLR32},
+    {"bext",   OP_BEXT,   OP_BEXT32},
+    {"binv",   OP_BINV,   OP_BINV32},
+    {"bset",   OP_BSET,   OP_BSET32},
+    {"bclri",  OP_BCLRI,  OP_BCLRI32},
+    {"bexti",  OP_BEXTI,  OP_BEXTI},
+    {"binvi",  OP_BINVI,  OP_BINVI32},
+    {"bseti",  OP_BSETI,  OP_BSETI32},
+
+    {"czero.eqz", OP_CZEROEQZ, OP_CZEROEQZ},
+    {"czero.nez", OP_CZERONEZ, OP_CZERONEZ},
+
+    {"ecall",  OP_ECALL,  OP_ECALL},
+    {"ebreak", OP_EBREAK, OP_EBREAK},
+};
+
+#define NUM_OP_MAP (sizeof(op_map)/sizeof(op_map[0]))
+
+static const char *const abi_names[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0",   "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6",   "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8",   "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+
+/* ---------------------- Field extraction ---------------------- */
+static int32_t imm_I(uint32_t w) { return (int32_t)w >> 20; }
+
+static int32_t imm_S(uint32_t w) {
+    return ((int32_t)(w & 0xFE000000) >> 20) | ((w >> 7) & 0x1F);
+}
+
+static int32_t imm_B(uint32_t w) {
+    return ((int32_t)(w & 0x80000000) >> 19) |
+           ((w << 4)  & 0x800) |
+           ((w >> 20) & 0x7E0) |
+           ((w >> 7)  & 0x1E);
+}
+
+static int32_t imm_U(uint32_t w) { return (int32_t)(w & 0xFFFFF000); }
+
+static int32_t imm_J(uint32_t w) {
+    return ((int32_t)(w & 0x80000000) >> 11) |
+           (w & 0xFF000) |
+           ((w >> 9)  & 0x800) |
+           ((w >> 20) & 0x7FE);
+}
+
+/* ---------------------- Decoding ---------------------- */
+// op_map indexed by instr_def_t.id, so predecoding needs no string compares
+static uint8_t op_by_id[NUM_INSTRUCTIONS][2];   // [id][xlen == 64]
+static pthread_once_t op_by_id_once = PTHREAD_ONCE_INIT;
+
+static void build_op_by_id(void) {
+    for (size_t i = 0; i < NUM_INSTRUCTIONS; i++)
+        op_by_id[i][0] = op_by_id[i][1] = OP_ILLEGAL;
+
+    for (size_t i = 0; i < NUM_OP_MAP; i++) {
+        const instr_def_t *def = lookup_mnemonic(op_map[i].mnemonic);
+        if (!def)
+            continue;
+        // Both encodings of an XLEN-specific mnemonic share the handlers
+        const instr_def_t *forms[2] = {xlen_variant(def, 32), xlen_variant(def, 64)};
+        for (int f = 0; f < 2; f++) {
+            if (!forms[f]) continue;
+            op_by_id[forms[f]->id][0] = op_map[i].op32;
+            op_by_id[forms[f]->id][1] = op_map[i].op64;
+        }
+    }
+}
+
+static uint8_t lookup_op(const instr_def_t *def, int xlen) {
+    return op_by_id[def->id][xlen == 64];
+}
+
+// Resolve a pc-relative byte offset to an index into the predecoded array.
+// Targets outside the image land on the BADPC sentinel.
+static int32_t branch_target(size_t index, int32_t offset, size_t num_words) {
+    int64_t target = (int64_t)index * 4 + offset;
+    if (offset % 4 != 0 || target < 0 || target > (int64_t)num_words * 4)
+        return (int32_t)num_words + 1;
+    return (int32_t)(target / 4);
+}
+
+// Predecode the whole image once. Two sentinels follow the code:
+// [num_words] halts (pc ran off the end), [num_words + 1] faults.
+static sim_insn_t *predecode(const uint32_t *image, size_t num_words, int xlen) {
+    pthread_once(&op_by_id_once, build_op_by_id);
+
+    sim_insn_t *code = calloc(num_words + 2, sizeof(*code));
+    if (!code)
+        return NULL;
+
+    for (size_t i = 0; i < num_words; i++) {
+        uint32_t w = image[i];
+        const instr_def_t *def = decode_instruction(w);
+        sim_insn_t *in = &code[i];
+
+        in->rd  = (w >> 7)  & 0x1F;
+        in->rs1 = (w >> 15) & 0x1F;
+        in->rs2 = (w >> 20) & 0x1F;
+
+        // RV64-only instructions, and the other XLEN's rev8/zext.h, are illegal here
+        if (!def || (def->xlen && def->xlen != xlen)) {
+            in->op  = OP_ILLEGAL;
+            in->imm = (int32_t)w;
+            continue;
+        }
+
+        in->op = lookup_op(def, xlen);
+        if (in->op == OP_ILLEGAL) {
+            in->imm = (int32_t)w;
+            continue;
+        }
+
+        switch (def->format) {
+            case TYPE_I7:
+                // 6 bits for shamtd forms (slli, rori, slli.uw, ...) on RV64
+                in->imm = (w >> 20) & ((xlen == 64 && def->shamt_bits == 6) ? 0x3F : 0x1F);
+                break;
+            case TYPE_S:
+                in->imm = imm_S(w);
+                break;
+            case TYPE_B:
+                in->imm = branch_target(i, imm_B(w), num_words);
+                break;
+            case TYPE_U:
+                in->imm = imm_U(w);
+                break;
+            case TYPE_J:
+                in->imm = branch_target(i, imm_J(w), num_words);
+                break;
+            default:
+                in->imm = imm_I(w);
+                break;
+        }
+
+        // Pure register writes to x0 have no effect at all
+        int pure = def->format == TYPE_R || def->format == TYPE_I7 || def->format == TYPE_U ||
+                   (def->format == TYPE_I && (def->opcode == 0x13 || def->opcode == 0x1B));
+        if (pure && in->rd == 0)
+            in->op = OP_NOP;
+    }
+
+    code[num_words].op     = OP_HALT;
+    code[num_words + 1].op = OP_BADPC;
+
+    return code;
+}
+
+/* ---------------------- Arithmetic helpers ---------------------- */
+static uint64_t mulhu64(uint64_t a, uint64_t b) {
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi;
+    uint64_t p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+    return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
+static uint64_t mulh64(uint64_t a, uint64_t b) {
+    uint64_t h = mulhu64(a, b);
+    if ((int64_t)a < 0) h -= b;
+    if ((int64_t)b < 0) h -= a;
+    return h;
+}
+
+static uint64_t mulhsu64(uint64_t a, uint64_t b) {
+    uint64_t h = mulhu64(a, b);
+    if ((int64_t)a < 0) h -= b;
+    return h;
+}
+
+// Bit-manipulation helpers (Zbb)
+static uint64_t clz64(uint64_t v, int bits) {
+    uint64_t n = 0;
+    for (uint64_t bit = (uint64_t)1 << (bits - 1); bit && !(v & bit); bit >>= 1)
+        n++;
+    return n;
+}
+
+static uint64_t ctz64(uint64_t v, int bits) {
+    uint64_t n = 0;
+    while (n < (uint64_t)bits && !(v & 1)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+}
+
+static uint64_t cpop64(uint64_t v) {
+    uint64_t n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+}
+
+static uint64_t rotr64(uint64_t v, unsigned n) {
+    n &= 63;
+    return n ? (v >> n) | (v << (64 - n)) : v;
+}
+
+static uint32_t rotr32(uint32_t v, unsigned n) {
+    n &= 31;
+    return n ? (v >> n) | (v << (32 - n)) : v;
+}
+
+static uint64_t orc_b(uint64_t v) {
+    uint64_t r = 0;
+    for (int i = 0; i < 64; i += 8)
+        if ((v >> i) & 0xFF)
+            r |= (uint64_t)0xFF << i;
+    return r;
+}
+
+static uint64_t rev8_64(uint64_t v, int bytes) {
+    uint64_t r = 0;
+    for (int i = 0; i < bytes; i++) {
+        r = (r << 8) | (v & 0xFF);
+        v >>= 8;
+    }
+    return r;
+}
+
+static uint64_t load_le(const uint8_t *p, int size) {
+    uint64_t v = 0;
+    for (int i = size - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static void store_le(uint8_t *p, uint64_t v, int size) {
+    for (int i = 0; i < size; i++) {
+        p[i] = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+/* ---------------------- Register dump ---------------------- */
+static void dump_registers(const uint64_t *r, uint64_t pc, uint64_t instret, int xlen) {
+    printf("---- RV%d register state (pc = 0x%08" PRIX64 ", %" PRIu64 " instructions) ----\n",
+           xlen, pc, instret);
+    for (int i = 0; i < 32; i++) {
+        if (xlen == 64)
+            printf("x%-2d %-4s = 0x%016" PRIX64, i, abi_names[i], r[i]);
+        else
+            printf("x%-2d %-4s = 0x%08" PRIX32, i, abi_names[i], (uint32_t)r[i]);
+        printf((i % 4 == 3) ? "\n" : "   ");
+    }
+}
+
+/* ---------------------- Execution ---------------------- */
+#define RD      r[ip->rd]
+#define RS1     r[ip->rs1]
+#define RS2     r[ip->rs2]
+#define IMM     ((uint64_t)(int64_t)ip->imm)
+#define PC      ((uint64_t)(ip - code) * 4)
+#define SEXT32(v) ((uint64_t)(int64_t)(int32_t)(uint32_t)(v))
+
+// Threaded dispatch via computed goto on GCC/Clang, plain switch elsewhere
+#if defined(__GNUC__)
+#define CASE(name) L_##name
+#define NEXT       do { instret++; goto *dispatch[ip->op]; } while (0)
+#else
+#define CASE(name) case OP_##name
+#define NEXT       goto next
+#endif
+
+#define ALU(name, expr)  CASE(name): RD = (expr); ip++; NEXT;
+
+#define LOAD(name, size, conv) \
+    CASE(name): { \
+        uint64_t addr = RS1 + IMM; \
+        if (addr > SIM_MEM_SIZE - (size)) { fault_addr = addr; goto mem_fault; } \
+        RD = conv(load_le(mem + addr, size)); \
+        r[0] = 0; ip++; NEXT; \
+    }
+
+#define STORE(name, size) \
+    CASE(name): { \
+        uint64_t addr = RS1 + IMM; \
+        if (addr > SIM_MEM_SIZE - (size)) { fault_addr = addr; goto mem_fault; } \
+        store_le(mem + addr, RS2, size); \
+        ip++; NEXT; \
+    }
+
+#define BRANCH(name, cond) \
+    CASE(name): \
+        if (cond) { \
+            if (instret >= SIM_MAX_STEPS) goto step_limit; \
+            ip = code + ip->imm; \
+        } else { \
+            ip++; \
+        } \
+        NEXT;
+
+#define AS_I8(v)   ((uint64_t)(int64_t)(int8_t)(v))
+#define AS_I16(v)  ((uint64_t)(int64_t)(int16_t)(v))
+#define AS_I32(v)  SEXT32(v)
+#define AS_U(v)    (v)
+
+static int execute(const sim_insn_t *code, size_t num_words, uint8_t *mem, int xlen) {
+    uint64_t r[32] = {0};
+    const sim_insn_t *ip = code;
+    uint64_t instret = 0;
+    uint64_t fault_addr = 0;
+    int exit_code = -1;
+
+    r[2] = SIM_MEM_SIZE;  // sp at top of memory
+
+#if defined(__GNUC__)
+    static const void *const dispatch[NUM_OPS] = {
+#define X(name) &&L_##name,
+        SIM_OPS(X)
+#undef X
+    };
+    NEXT;
+#else
+next:
+    instret++;
+    switch (ip->op) {
+#endif
+
+    /* ---- R-Type ---- */
+    ALU(ADD,   RS1 + RS2)
+    ALU(SUB,   RS1 - RS2)
+    ALU(SLL,   RS1 << (RS2 & 63))
+    ALU(SLT,   (int64_t)RS1 < (int64_t)RS2)
+    ALU(SLTU,  RS1 < RS2)
+    ALU(XOR,   RS1 ^ RS2)
+    ALU(SRL,   RS1 >> (RS2 & 63))
+    ALU(SRA,   (uint64_t)((int64_t)RS1 >> (RS2 & 63)))
+    ALU(OR,    RS1 | RS2)
+    ALU(AND,   RS1 & RS2)
+
+    /* ---- I-Type ALU ---- */
+    ALU(ADDI,  RS1 + IMM)
+    ALU(SLTI,  (int64_t)RS1 < (int64_t)IMM)
+    ALU(SLTIU, RS1 < IMM)
+    ALU(XORI,  RS1 ^ IMM)
+    ALU(ORI,   RS1 | IMM)
+    ALU(ANDI,  RS1 & IMM)
+    ALU(SLLI,  RS1 << ip->imm)
+    ALU(SRLI,  RS1 >> ip->imm)
+    ALU(SRAI,  (uint64_t)((int64_t)RS1 >> ip->imm))
+
+    /* ---- Loads / Stores ---- */
+    LOAD(LB,  1, AS_I8)
+    LOAD(LH,  2, AS_I16)
+    LOAD(LW,  4, AS_I32)
+    LOAD(LBU, 1, AS_U)
+    LOAD(LHU, 2, AS_U)
+    LOAD(LD,  8, AS_U)
+    LOAD(LWU, 4, AS_U)
+
+    STORE(SB, 1)
+    STORE(SH, 2)
+    STORE(SW, 4)
+    STORE(SD, 8)
+
+    /* ---- Branches ---- */
+    BRANCH(BEQ,  RS1 == RS2)
+    BRANCH(BNE,  RS1 != RS2)
+    BRANCH(BLT,  (int64_t)RS1 <  (int64_t)RS2)
+    BRANCH(BGE,  (int64_t)RS1 >= (int64_t)RS2)
+    BRANCH(BLTU, RS1 <  RS2)
+    BRANCH(BGEU, RS1 >= RS2)
+
+    /* ---- U-Type / Jumps ---- */
+    ALU(LUI,   IMM)
+    ALU(AUIPC, (xlen == 64) ? PC + IMM : SEXT32(PC + IMM))
+
+    CASE(JAL):
+        if (instret >= SIM_MAX_STEPS) goto step_limit;
+        RD = PC + 4;
+        r[0] = 0;
+        ip = code + ip->imm;
+        NEXT;
+
+    CASE(JALR): {
+        uint64_t target = (RS1 + IMM) & ~(uint64_t)1;
+        if (instret >= SIM_MAX_STEPS) goto step_limit;
+        RD = PC + 4;
+        r[0] = 0;
+        if ((target & 3) || target / 4 > num_words) {
+            ip = code + num_words + 1;
+        } else {
+            ip = code + target / 4;
+        }
+        NEXT;
+    }
+
+    /* ---- RV64 word ops (also the RV32 handlers) ---- */
+    ALU(ADDW,  SEXT32(RS1 + RS2))
+    ALU(SUBW,  SEXT32(RS1 - RS2))
+    ALU(SLLW,  SEXT32((uint32_t)RS1 << (RS2 & 31)))
+    ALU(SRLW,  SEXT32((uint32_t)RS1 >> (RS2 & 31)))
+    ALU(SRAW,  SEXT32((int32_t)RS1 >> (RS2 & 31)))
+    ALU(ADDIW, SEXT32(RS1 + IMM))
+    ALU(SLLIW, SEXT32((uint32_t)RS1 << ip->imm))
+    ALU(SRLIW, SEXT32((uint32_t)RS1 >> ip->imm))
+    ALU(SRAIW, SEXT32((int32_t)RS1 >> ip->imm))
+
+    /* ---- M extension ---- */
+    ALU(MUL,    RS1 * RS2)
+    ALU(MULH,   mulh64(RS1, RS2))
+    ALU(MULHSU, mulhsu64(RS1, RS2))
+    ALU(MULHU,  mulhu64(RS1, RS2))
+    ALU(DIV,    RS2 == 0 ? ~(uint64_t)0 :
+                (RS1 == (uint64_t)INT64_MIN && RS2 == ~(uint64_t)0) ? RS1 :
+                (uint64_t)((int64_t)RS1 / (int64_t)RS2))
+    ALU(DIVU,   RS2 == 0 ? ~(uint64_t)0 : RS1 / RS2)
+    ALU(REM,    RS2 == 0 ? RS1 :
+                (RS1 == (uint64_t)INT64_MIN && RS2 == ~(uint64_t)0) ? 0 :
+                (uint64_t)((int64_t)RS1 % (int64_t)RS2))
+    ALU(REMU,   RS2 == 0 ? RS1 : RS1 % RS2)
+
+    ALU(MULW,   SEXT32((uint32_t)RS1 * (uint32_t)RS2))
+    ALU(DIVW,   (int32_t)RS2 == 0 ? ~(uint64_t)0 :
+                ((int32_t)RS1 == INT32_MIN && (int32_t)RS2 == -1) ? SEXT32(RS1) :
+                SEXT32((int32_t)RS1 / (int32_t)RS2))
+    ALU(DIVUW,  (uint32_t)RS2 == 0 ? ~(uint64_t)0 : SEXT32((uint32_t)RS1 / (uint32_t)RS2))
+    ALU(REMW,   (int32_t)RS2 == 0 ? SEXT32(RS1) :
+                ((int32_t)RS1 == INT32_MIN && (int32_t)RS2 == -1) ? 0 :
+                SEXT32((int32_t)RS1 % (int32_t)RS2))
+    ALU(REMUW,  (uint32_t)RS2 == 0 ? SEXT32(RS1) : SEXT32((uint32_t)RS1 % (uint32_t)RS2))
+
+    ALU(MULH32,   SEXT32(((int64_t)(int32_t)RS1 * (int64_t)(int32_t)RS2) >> 32))
+    ALU(MULHSU32, SEXT32(((int64_t)(int32_t)RS1 * (int64_t)(uint32_t)RS2) >> 32))
+    ALU(MULHU32,  SEXT32(((uint64_t)(uint32_t)RS1 * (uint32_t)RS2) >> 32))
+
+    /* ---- Zba ---- */
+    ALU(SH1ADD,   (RS1 << 1) + RS2)
+    ALU(SH2ADD,   (RS1 << 2) + RS2)
+    ALU(SH3ADD,   (RS1 << 3) + RS2)
+    ALU(SH1ADD32, SEXT32((RS1 << 1) + RS2))
+    ALU(SH2ADD32, SEXT32((RS1 << 2) + RS2))
+    ALU(SH3ADD32, SEXT32((RS1 << 3) + RS2))
+    ALU(ADDUW,    (uint64_t)(uint32_t)RS1 + RS2)
+    ALU(SH1ADDUW, ((uint64_t)(uint32_t)RS1 << 1) + RS2)
+    ALU(SH2ADDUW, ((uint64_t)(uint32_t)RS1 << 2) + RS2)
+    ALU(SH3ADDUW, ((uint64_t)(uint32_t)RS1 << 3) + RS2)
+    ALU(SLLIUW,   (uint64_t)(uint32_t)RS1 << ip->imm)
+
+    /* ---- Zbb ---- */
+    ALU(ANDN,  RS1 & ~RS2)
+    ALU(ORN,   RS1 | ~RS2)
+    ALU(XNOR,  ~(RS1 ^ RS2))
+    ALU(MIN,   (int64_t)RS1 < (int64_t)RS2 ? RS1 : RS2)
+    ALU(MINU,  RS1 < RS2 ? RS1 : RS2)
+    ALU(MAX,   (int64_t)RS1 > (int64_t)RS2 ? RS1 : RS2)
+    ALU(MAXU,  RS1 > RS2 ? RS1 : RS2)
+    ALU(ROL,   rotr64(RS1, 64 - (RS2 & 63)))
+    ALU(ROR,   rotr64(RS1, RS2 & 63))
+    ALU(RORI,  rotr64(RS1, ip->imm))
+    ALU(ROLW,  SEXT32(rotr32((uint32_t)RS1, 32 - (RS2 & 31))))
+    ALU(RORW,  SEXT32(rotr32((uint32_t)RS1, RS2 & 31)))
+    ALU(RORIW, SEXT32(rotr32((uint32_t)RS1, ip->imm)))
+    ALU(CLZ,   clz64(RS1, 64))
+    ALU(CTZ,   ctz64(RS1, 64))
+    ALU(CPOP,  cpop64(RS1))
+    ALU(CLZW,  clz64((uint32_t)RS1, 32))
+    ALU(CTZW,  ctz64((uint32_t)RS1, 32))
+    ALU(CPOPW, cpop64((uint32_t)RS1))
+    ALU(SEXTB, AS_I8(RS1))
+    ALU(SEXTH, AS_I16(RS1))
+    ALU(ZEXTH, RS1 & 0xFFFF)
+    ALU(ORCB,  orc_b(RS1))
+    ALU(REV8,  rev8_64(RS1, 8))
+    ALU(REV8_32, SEXT32(rev8_64(RS1, 4)))
+
+    /* ---- Zbs ---- */
+    ALU(BCLR,    RS1 & ~((uint64_t)1 << (RS2 & 63)))
+    ALU(BEXT,    (RS1 >> (RS2 & 63)) & 1)
+    ALU(BINV,    RS1 ^ ((uint64_t)1 << (RS2 & 63)))
+    ALU(BSET,    RS1 | ((uint64_t)1 << (RS2 & 63)))
+    ALU(BCLRI,   RS1 & ~((uint64_t)1 << ip->imm))
+    ALU(BEXTI,   (RS1 >> ip->imm) & 1)
+    ALU(BINVI,   RS1 ^ ((uint64_t)1 << ip->imm))
+    ALU(BSETI,   RS1 | ((uint64_t)1 << ip->imm))
+    ALU(BCLR32,  SEXT32(RS1 & ~((uint64_t)1 << (RS2 & 31))))
+    ALU(BEXT32,  (RS1 >> (RS2 & 31)) & 1)
+    ALU(BINV32,  SEXT32(RS1 ^ ((uint64_t)1 << (RS2 & 31))))
+    ALU(BSET32,  SEXT32(RS1 | ((uint64_t)1 << (RS2 & 31))))
+    ALU(BCLRI32, SEXT32(RS1 & ~((uint64_t)1 << ip->imm)))
+    ALU(BINVI32, SEXT32(RS1 ^ ((uint64_t)1 << ip->imm)))
+    ALU(BSETI32, SEXT32(RS1 | ((uint64_t)1 << ip->imm)))
+
+    /* ---- Zicond ---- */
+    ALU(CZEROEQZ, RS2 == 0 ? 0 : RS1)
+    ALU(CZERONEZ, RS2 != 0 ? 0 : RS1)
+
+    /* ---- System / sentinels ---- */
+    CASE(ECALL):
+        exit_code = (int)r[10];
+        printf("ecall: exit with code %d\n", exit_code);
+        goto done;
+
+    CASE(EBREAK):
+        exit_code = (int)r[10];
+        printf("ebreak: stopped\n");
+        goto done;
+
+    CASE(NOP):
+        ip++;
+        NEXT;
+
+    CASE(HALT):
+        instret--;  // the sentinel itself does not retire
+        exit_code = (int)r[10];
+        printf("End of program reached\n");
+        goto done;
+
+    CASE(BADPC):
+        instret--;
+        printf("Simulation fault: jump target outside program\n");
+        goto done;
+
+    CASE(ILLEGAL):
+        instret--;
+        printf("Simulation fault: unsupported instruction %08X at pc 0x%08" PRIX64 "\n",
+               (uint32_t)ip->imm, PC);
+        goto done;
+
+#if !defined(__GNUC__)
+    default:
+        goto done;
+    }
+#endif
+
+mem_fault:
+    printf("Simulation fault: memory access at 0x%08" PRIX64 " out of range (pc 0x%08" PRIX64 ")\n",
+           fault_addr, PC);
+    goto done;
+
+step_limit:
+    printf("Simulation stopped: step limit of %llu reached\n",
+           (unsigned long long)SIM_MAX_STEPS);
+
+done:
+    dump_registers(r, PC, instret, xlen);
+    return exit_code;
+}
+
+/* ---------------------- Entry point ---------------------- */
+int simulate(const uint32_t *image, size_t num_words, int xlen) {
+    if ((uint64_t)num_words * 4 > SIM_MEM_SIZE) {
+        printf("Program too large for simulated memory\n");
+        return -1;
+    }
+
+    sim_insn_t *code = predecode(image, num_words, xlen);
+    uint8_t *mem = calloc(SIM_MEM_SIZE, 1);
+    if (!code || !mem) {
+        printf("Out of memory\n");
+        free(code);
+        free(mem);
+        return -1;
+    }
+
+    // Code is also visible as data; stores to it do not affect the predecoded copy
+    for (size_t i = 0; i < num_words; i++)
+        store_le(mem + i * 4, image[i], 4);
+
+    int exit_code = execute(code, num_words, mem, xlen);
+
+    free(mem);
+    free(code);
+    return exit_code;
+}
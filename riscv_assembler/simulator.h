@@ -0,0 +1,24 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Size of the flat simulated memory; the image is loaded at address 0
+// and sp (x2) starts at the top of memory.
+#ifndef SIM_MEM_SIZE
+#define SIM_MEM_SIZE (4u * 1024u * 1024u)
+#endif
+
+// Upper bound on executed instructions, so a runaway loop cannot hang CI.
+#ifndef SIM_MAX_STEPS
+#define SIM_MAX_STEPS 100000000ull
+#endif
+
+// Predecode the assembled image and execute it in-process as an RV32 or
+// RV64 (xlen) hart. Execution stops on ecall (exit code = a0), ebreak, or
+// when the pc runs off the end of the image. Register state is dumped on
+// exit. Returns the program exit code, or -1 on a simulation fault.
+int simulate(const uint32_t *image, size_t num_words, int xlen);
+
+#endif // SIMULATOR_H
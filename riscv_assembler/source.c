@@ -0,0 +1,326 @@
+// source.c
+#if !defined(_WIN32)
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "source.h"
+#include "assembler.h"
+
+#define INCLUDE_CACHE_BUCKETS 64
+
+// Sub-second part of st_mtime, so edits within one second are still seen
+#if defined(_WIN32)
+#define STAT_MTIME_NSEC(st) 0L
+#elif defined(__APPLE__)
+#define STAT_MTIME_NSEC(st) ((long)(st).st_mtimespec.tv_nsec)
+#else
+#define STAT_MTIME_NSEC(st) ((long)(st).st_mtim.tv_nsec)
+#endif
+
+/* ---------------------- Types ---------------------- */
+typedef struct cache_entry {
+    source_unit_t *unit;
+    struct cache_entry *next;
+} cache_entry_t;
+
+/* ---------------------- Globals ---------------------- */
+static char *include_paths[MAX_INCLUDE_PATHS];
+static int include_path_count = 0;
+
+// Shared by every thread; units are immutable once inserted apart from
+// refs/evicted, which are guarded by the lock. A unit that goes stale (file
+// changed) is unlinked at once and freed when its last user releases it.
+static cache_entry_t *include_cache[INCLUDE_CACHE_BUCKETS];
+static pthread_mutex_t include_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ---------------------- Helpers ---------------------- */
+static char *copy_string(const char *s, size_t len) {
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, s, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+static int is_absolute_path(const char *path) {
+    if (path[0] == '/' || path[0] == '\\')
+        return 1;
+    return isalpha((unsigned char)path[0]) && path[1] == ':';
+}
+
+static char *directory_of(const char *path) {
+    const char *slash = NULL;
+    for (const char *p = path; *p; p++)
+        if (*p == '/' || *p == '\\')
+            slash = p;
+    return slash ? copy_string(path, (size_t)(slash - path + 1)) : copy_string("", 0);
+}
+
+int canonical_path(const char *path, char *out, size_t out_size) {
+#if defined(_WIN32)
+    return _fullpath(out, path, out_size) != NULL;
+#else
+    char *resolved = realpath(path, NULL);
+    int ok = resolved && strlen(resolved) < out_size;
+    if (ok) strcpy(out, resolved);
+    free(resolved);
+    return ok;
+#endif
+}
+
+static uint32_t hash_path(const char *path) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*path) {
+        h ^= (unsigned char)*path++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* ---------------------- Tokenizer ---------------------- */
+static int add_line(source_unit_t *unit, size_t *capacity, const source_line_t *line) {
+    if (unit->num_lines == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        source_line_t *grown = realloc(unit->lines, new_capacity * sizeof(*grown));
+        if (!grown) return 0;
+        unit->lines = grown;
+        *capacity = new_capacity;
+    }
+    unit->lines[unit->num_lines++] = *line;
+    return 1;
+}
+
+// True if `ptr` starts with the directive `name` followed by space or end of line
+static int is_directive(const char *ptr, const char *name) {
+    size_t len = strlen(name);
+    return strncmp(ptr, name, len) == 0 && (ptr[len] == '\0' || isspace((unsigned char)ptr[len]));
+}
+
+// Returns the path between the quotes of `.include "path"`, or NULL if malformed.
+// Resolution and cycle detection happen later, in the assembler's expand_unit.
+static char *parse_include(const char *ptr) {
+    ptr += strlen(".include");
+    while (isspace((unsigned char)*ptr)) ptr++;
+    if (*ptr != '"') return NULL;
+    const char *close = strchr(ptr + 1, '"');
+    if (!close || close == ptr + 1) return NULL;
+    return copy_string(ptr + 1, (size_t)(close - ptr - 1));
+}
+
+source_unit_t *tokenize_stream(FILE *file, const char *path) {
+    source_unit_t *unit = calloc(1, sizeof(*unit));
+    if (!unit) return NULL;
+    unit->path = copy_string(path, strlen(path));
+    unit->dir  = directory_of(path);
+    if (!unit->path || !unit->dir) { free_unit(unit); return NULL; }
+
+    char line[MAX_LINE_LEN];
+    size_t capacity = 0;
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        line[strcspn(line, "\n")] = 0; // remove newline
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *ptr = line;
+        while (isspace((unsigned char)*ptr)) ptr++;  // trim leading space
+        if (*ptr == '\0') continue; // skip empty/comment lines
+
+        source_line_t entry = {0};
+        entry.line_no = line_no;
+
+        if (is_directive(ptr, ".include")) {
+            entry.kind = SRC_INCLUDE;
+            entry.text = parse_include(ptr);
+        } else if (is_directive(ptr, ".globl") || is_directive(ptr, ".global")) {
+            entry.kind = SRC_GLOBAL;
+            ptr += strcspn(ptr, " \t");
+            while (isspace((unsigned char)*ptr)) ptr++;
+            entry.text = copy_string(ptr, strcspn(ptr, " \t\r"));
+            if (!entry.text) { free_unit(unit); return NULL; }
+        } else if (strchr(ptr, ':')) {
+            entry.kind = SRC_LABEL;
+            entry.text = copy_string(ptr, strcspn(ptr, ":"));
+            if (!entry.text) { free_unit(unit); return NULL; }
+        } else {
+            entry.kind = SRC_INSTR;
+            entry.text = copy_string(line, strlen(line));
+
+            // trim trailing whitespace
+            char *end = ptr + strlen(ptr) - 1;
+            while (end > ptr && isspace((unsigned char)*end)) *end-- = '\0';
+
+            /* Extract mnemonic + operands */
+            size_t len = 0;
+            while (ptr[len] && !isspace((unsigned char)ptr[len]) && len < 31) len++;
+            entry.mnemonic = copy_string(ptr, len);
+            ptr += len;
+            while (isspace((unsigned char)*ptr)) ptr++;
+            entry.operands = copy_string(ptr, strlen(ptr));
+
+            if (!entry.text || !entry.mnemonic || !entry.operands) {
+                free(entry.text); free(entry.mnemonic); free(entry.operands);
+                free_unit(unit);
+                return NULL;
+            }
+            entry.def = find_instruction(entry.mnemonic);
+        }
+
+        if (!add_line(unit, &capacity, &entry)) {
+            free(entry.text); free(entry.mnemonic); free(entry.operands);
+            free_unit(unit);
+            return NULL;
+        }
+    }
+
+    return unit;
+}
+
+void free_unit(source_unit_t *unit) {
+    if (!unit) return;
+    for (size_t i = 0; i < unit->num_lines; i++) {
+        free(unit->lines[i].text);
+        free(unit->lines[i].mnemonic);
+        free(unit->lines[i].operands);
+    }
+    free(unit->lines);
+    free(unit->path);
+    free(unit->dir);
+    free(unit);
+}
+
+/* ---------------------- Include paths ---------------------- */
+int add_include_path(const char *dir) {
+    if (include_path_count >= MAX_INCLUDE_PATHS)
+        return 0;
+    size_t len = strlen(dir);
+    char *copy = malloc(len + 2);
+    if (!copy) return 0;
+    strcpy(copy, dir);
+    if (len && dir[len - 1] != '/' && dir[len - 1] != '\\')
+        strcat(copy, "/");
+    include_paths[include_path_count++] = copy;
+    return 1;
+}
+
+static int try_path(const char *dir, const char *name, char *out, size_t out_size) {
+    struct stat st;
+    if ((size_t)snprintf(out, out_size, "%s%s", dir, name) >= out_size)
+        return 0;
+    return stat(out, &st) == 0 && !S_ISDIR(st.st_mode);
+}
+
+int resolve_include(const char *name, const source_unit_t *from, char *out, size_t out_size) {
+    if (is_absolute_path(name))
+        return try_path("", name, out, out_size);
+
+    if (try_path(from->dir, name, out, out_size))
+        return 1;
+    for (int i = 0; i < include_path_count; i++)
+        if (try_path(include_paths[i], name, out, out_size))
+            return 1;
+    return 0;
+}
+
+/* ---------------------- Include cache ---------------------- */
+static int unit_matches(const source_unit_t *unit, const struct stat *st) {
+    return unit->mtime == st->st_mtime &&
+           unit->mtime_nsec == STAT_MTIME_NSEC(*st) &&
+           unit->size == (long long)st->st_size &&
+           unit->inode == (unsigned long long)st->st_ino;
+}
+
+// Looks up `canonical` in its bucket with the cache lock held. A hit takes a
+// reference; an entry whose file has changed since is evicted.
+static source_unit_t *find_cached(uint32_t bucket, const char *canonical, const struct stat *st) {
+    for (cache_entry_t **link = &include_cache[bucket]; *link; link = &(*link)->next) {
+        source_unit_t *cached = (*link)->unit;
+        if (strcmp(cached->path, canonical) != 0)
+            continue;
+        if (unit_matches(cached, st)) {
+            cached->refs++;
+            return cached;
+        }
+        cache_entry_t *stale = *link;   // file changed: drop from the cache
+        *link = stale->next;
+        free(stale);
+        cached->evicted = 1;
+        if (cached->refs == 0)
+            free_unit(cached);
+        return NULL;
+    }
+    return NULL;
+}
+
+// The file is read and tokenized without the lock, so threads including
+// different files do not wait on each other. If another thread cached the
+// same file meanwhile, its unit wins and ours is dropped.
+const source_unit_t *get_include_unit(const char *path) {
+    char canonical[MAX_PATH_LEN];
+    struct stat st;
+
+    if (!canonical_path(path, canonical, sizeof(canonical)) || stat(canonical, &st) != 0)
+        return NULL;
+
+    uint32_t bucket = hash_path(canonical) % INCLUDE_CACHE_BUCKETS;
+
+    pthread_mutex_lock(&include_cache_lock);
+    source_unit_t *cached = find_cached(bucket, canonical, &st);
+    pthread_mutex_unlock(&include_cache_lock);
+    if (cached)
+        return cached;
+
+    FILE *file = fopen(canonical, "r");
+    if (!file)
+        return NULL;
+    source_unit_t *unit = tokenize_stream(file, canonical);
+    fclose(file);
+    cache_entry_t *entry = malloc(sizeof(*entry));
+    if (!unit || !entry) {
+        free_unit(unit);
+        free(entry);
+        return NULL;
+    }
+    unit->mtime      = st.st_mtime;
+    unit->mtime_nsec = STAT_MTIME_NSEC(st);
+    unit->size       = (long long)st.st_size;
+    unit->inode      = (unsigned long long)st.st_ino;
+    unit->refs       = 1;
+
+    pthread_mutex_lock(&include_cache_lock);
+    cached = find_cached(bucket, canonical, &st);
+    if (!cached) {
+        entry->unit = unit;
+        entry->next = include_cache[bucket];
+        include_cache[bucket] = entry;
+    }
+    pthread_mutex_unlock(&include_cache_lock);
+
+    if (cached) {
+        free_unit(unit);
+        free(entry);
+        return cached;
+    }
+    return unit;
+}
+
+void release_include_unit(const source_unit_t *unit) {
+    source_unit_t *owned = (source_unit_t *)unit;   // the cache owns it
+
+    pthread_mutex_lock(&include_cache_lock);
+    if (--owned->refs == 0 && owned->evicted)
+        free_unit(owned);
+    pthread_mutex_unlock(&include_cache_lock);
+}
@@ -0,0 +1,68 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "instruction_defs.h"
+
+#define MAX_INCLUDE_PATHS 32
+#define MAX_INCLUDE_DEPTH 32
+#define MAX_PATH_LEN 1024
+
+typedef enum {
+    SRC_LABEL,     // "name:"
+    SRC_INSTR,     // mnemonic + operands
+    SRC_INCLUDE,   // .include "file"
+    SRC_GLOBAL     // .globl/.global name
+} source_kind_t;
+
+// One significant line of a source file, tokenized once
+typedef struct {
+    source_kind_t kind;
+    int line_no;
+    char *text;          // SRC_INSTR: comment-stripped line as shown in the trace
+                         // SRC_LABEL, SRC_GLOBAL: symbol name; SRC_INCLUDE: path (NULL if malformed)
+    char *mnemonic;      // SRC_INSTR only
+    char *operands;      // SRC_INSTR only
+    instr_def_t *def;    // SRC_INSTR only, NULL for an unknown mnemonic
+} source_line_t;
+
+// A tokenized source file. Units returned by get_include_unit() are
+// shared between all sources (and threads) and must not be modified.
+typedef struct {
+    char *path;
+    char *dir;           // directory used to resolve relative includes ("" = cwd)
+    time_t mtime;        // cache key: mtime, size and inode of the file
+    long mtime_nsec;
+    long long size;
+    unsigned long long inode;
+    int refs;            // cached units: assemblies still using it (under the cache lock)
+    int evicted;         // cached units: dropped from the cache, freed at refs == 0
+    source_line_t *lines;
+    size_t num_lines;
+} source_unit_t;
+
+// Tokenize a stream. The caller owns the result (free with free_unit()).
+source_unit_t *tokenize_stream(FILE *file, const char *path);
+void free_unit(source_unit_t *unit);
+
+// Absolute, symlink-free form of an existing path. Returns 0 on failure.
+int canonical_path(const char *path, char *out, size_t out_size);
+
+// Add a directory searched for .include files after the including file's directory
+int add_include_path(const char *dir);
+
+// Find an include file: absolute paths as-is, otherwise relative to the
+// including unit's directory, then each include path. Returns 0 if not found.
+int resolve_include(const char *name, const source_unit_t *from, char *out, size_t out_size);
+
+// Tokenized include file from the process-wide cache, keyed by canonical
+// path, mtime (to the nanosecond where available), size and inode.
+// Returns NULL if the file cannot be read. Every unit returned must be
+// handed back with release_include_unit() once the assembly is done.
+const source_unit_t *get_include_unit(const char *path);
+void release_include_unit(const source_unit_t *unit);
+
+#endif // SOURCE_H
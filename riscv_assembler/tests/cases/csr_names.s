@@ -0,0 +1,14 @@
+# CSR operands by name and by number, and writes to read-only CSRs
+csrrs x1, cycle, x0
+csrrs x2, mstatus, x0
+csrrw x0, mtvec, x5
+csrrs x3, 0x305, x0
+csrrs x4, pmpaddr63, x0
+csrrs x5, mhpmcounter31h, x0
+csrrsi x6, fcsr, 0
+rdcycleh x7
+csrrw x0, cycle, x1
+csrrsi x0, 0xC02, 1
+csrrc x0, time, x0
+csrrs x8, bogus, x0
+csrrw x0, 0x1000, x1
@@ -0,0 +1,7 @@
+# The RV32-only upper counter halves on RV64
+rdcycle x1
+rdcycleh x2
+csrrs x3, cycleh, x0
+csrrs x4, 0xB80, x0
+csrrs x5, mstatush, x0
+csrrs x6, pmpcfg2, x0
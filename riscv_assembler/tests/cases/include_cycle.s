@@ -0,0 +1,3 @@
+# a includes b includes a: the second .include of a is rejected
+.include "inc/cycle_a.inc"
+addi x12, x0, 3
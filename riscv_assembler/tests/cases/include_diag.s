@@ -0,0 +1,3 @@
+# Diagnostics from an included file carry its name and line
+.include "inc/bad.inc"
+addi x6, x0, 6
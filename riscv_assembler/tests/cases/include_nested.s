@@ -0,0 +1,3 @@
+# Nested includes resolve relative to the including file
+.include "inc/outer.inc"
+addi x4, x0, 4
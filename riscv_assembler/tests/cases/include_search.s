@@ -0,0 +1,4 @@
+# -I directories are searched in command-line order, after the includer's own directory
+.include "common.inc"
+.include "extra.inc"
+.include "uses_local.inc"
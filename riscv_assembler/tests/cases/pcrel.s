@@ -0,0 +1,12 @@
+# auipc/%pcrel_lo pairs resolved within one file
+here:
+auipc x10, %pcrel_hi(data)
+lw x11, %pcrel_lo(here)(x10)
+sw x11, %pcrel_lo(here)(x10)
+addi x12, x10, %pcrel_lo(here)
+addi x13, x0, 0
+far:
+auipc x14, data
+jalr x0, x14, %pcrel_lo(far)
+data:
+addi x0, x0, 0
@@ -0,0 +1,3 @@
+# RV64-only instructions are errors in an RV32 image
+addw x1, x2, x3
+slli.uw x1, x2, 3
@@ -0,0 +1,5 @@
+# Out-of-range shift amounts are rejected: RV32 stops at 31
+slli x1, x2, 31
+slli x1, x2, 32
+rori x1, x2, 40
+bseti x1, x2, -1
@@ -0,0 +1,4 @@
+# RV64: 0..63, but the *w forms still stop at 31
+slli x1, x2, 64
+slliw x1, x2, 32
+roriw x1, x2, 32
@@ -0,0 +1,12 @@
+# RV64 shift amounts of 32 and above use bit 25 (shamtd)
+rori x5, x6, 40
+bclri x7, x8, 35
+bseti x7, x8, 35
+binvi x7, x8, 63
+bexti x7, x8, 32
+slli.uw x9, x10, 33
+slli x11, x12, 40
+srli x11, x12, 32
+srai x11, x12, 63
+slliw x13, x14, 31
+roriw x13, x14, 31
@@ -0,0 +1,4 @@
+# Jumping past the end of the image faults with the registers intact
+addi x5, x0, 100
+jalr x1, x5, 0
+ecall
@@ -0,0 +1,12 @@
+# Division by zero does not trap: quotient is all ones, remainder is the dividend
+addi x5, x0, 7
+div x6, x5, x0
+divu x7, x5, x0
+rem x8, x5, x0
+remu x9, x5, x0
+lui x11, 0x80000
+addi x12, x0, -1
+div x13, x11, x12
+rem x14, x11, x12
+addi x10, x8, 0
+ecall
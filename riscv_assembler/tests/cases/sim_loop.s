@@ -0,0 +1,8 @@
+# Sum 1..10 in a counted loop; the sum is the exit code
+addi x5, x0, 10
+addi x10, x0, 0
+loop:
+add x10, x10, x5
+addi x5, x5, -1
+bne x5, x0, loop
+ecall
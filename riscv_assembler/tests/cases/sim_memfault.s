@@ -0,0 +1,5 @@
+# A load outside simulated memory faults at the load's pc
+addi x5, x0, 1
+lui x6, 0x7FFFF
+lw x7, 0(x6)
+ecall
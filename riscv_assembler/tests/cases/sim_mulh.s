@@ -0,0 +1,11 @@
+# High halves of signed, unsigned and mixed 32-bit products; mulhu of -2 by 3 is the exit code
+addi x5, x0, -2
+addi x6, x0, 3
+mulh x7, x5, x6
+mulhu x8, x5, x6
+mulhsu x9, x5, x6
+lui x11, 0x10000
+mulhu x12, x11, x11
+mul x13, x5, x6
+addi x10, x8, 0
+ecall
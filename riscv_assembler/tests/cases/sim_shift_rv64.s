@@ -0,0 +1,13 @@
+# RV64 shifts by 32 and more, checked in the register dump
+addi x5, x0, -1
+slli x6, x5, 32
+srli x7, x5, 32
+srai x8, x6, 16
+addi x9, x0, 3
+slli.uw x11, x9, 33
+rori x12, x9, 40
+bseti x13, x0, 35
+bexti x14, x13, 35
+slliw x15, x9, 31
+addi x10, x14, 0
+ecall
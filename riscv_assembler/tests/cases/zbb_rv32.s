@@ -0,0 +1,3 @@
+# RV32 (the default): RV32 rev8 and zext.h
+rev8 x10, x11
+zext.h x10, x11
@@ -0,0 +1,4 @@
+# With --xlen 64, rev8 and zext.h take their RV64 encodings
+rev8 x10, x11
+zext.h x10, x11
+addw x1, x2, x3
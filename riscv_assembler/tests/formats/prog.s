@@ -0,0 +1,6 @@
+# Five distinct words: word128 and wider pad the last line, ihex needs two data records
+addi x1, x0, 1
+addi x2, x0, 2
+add x3, x1, x2
+lui x4, 0x12345
+ecall
@@ -0,0 +1,7 @@
+# auipc/%pcrel_lo pair whose target lives in another object
+.globl main
+main:
+here:
+auipc x10, %pcrel_hi(target)
+addi x10, x10, %pcrel_lo(here)
+ecall
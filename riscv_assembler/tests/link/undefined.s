@@ -0,0 +1,4 @@
+# branch to a symbol no object defines
+.globl main
+main:
+beq x0, x0, missing
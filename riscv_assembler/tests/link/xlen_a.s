@@ -0,0 +1,3 @@
+# rev8 and zext.h take the encoding of the selected XLEN
+rev8 x10, x11
+zext.h x12, x11
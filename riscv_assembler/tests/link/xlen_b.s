@@ -0,0 +1,2 @@
+# RV64-only instruction, an error in an RV32 link
+addw x1, x2, x3
@@ -0,0 +1,104 @@
+#!/bin/sh
+# Regression tests. Every tests/cases/NAME.s is assembled from inside
+# tests/cases with the mode and options in NAME.args (default: word).
+# NAME.hex, if present, must match the output file; NAME.out, if present,
+# must match stdout followed by an "[exit N]" line. Files under
+# tests/cases/inc are only reached through .include.
+# tests/formats/MODE.hex is the output of tests/formats/prog.s in MODE.
+# Usage: tests/run_tests.sh [assembler]   (builds one when not given)
+
+asm=$1
+case "$asm" in
+    ""|/*) ;;
+    *) asm=$PWD/$asm ;;
+esac
+
+cd "$(dirname "$0")/.." || exit 1
+cases=$(pwd -P)/tests/cases   # included files are reported by canonical path
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+
+if [ -z "$asm" ]; then
+    asm=$work/assembler
+    gcc -O2 -Wall -pthread main.c assembler.c source.c link.c parser.c encoder.c \
+        riscv_instructions.c instr_tables.c output.c map.c simulator.c server.c -o "$asm" || exit 1
+fi
+
+failures=0
+fail() { echo "FAIL: $1"; failures=$((failures + 1)); }
+
+for src in tests/cases/*.s; do
+    name=$(basename "$src" .s)
+    args=word
+    [ -f "tests/cases/$name.args" ] && args=$(cat "tests/cases/$name.args")
+
+    # shellcheck disable=SC2086  # args holds several words
+    (cd tests/cases && "$asm" "$name.s" "$work/$name.hex" $args) > "$work/$name.log" 2>&1
+    echo "[exit $?]" >> "$work/$name.log"
+    sed -e "s|$work/||g" -e "s|$cases/||g" "$work/$name.log" > "$work/$name.out"
+
+    ok=1
+    if [ -f "tests/cases/$name.hex" ] && ! cmp -s "$work/$name.hex" "tests/cases/$name.hex"; then ok=0; fi
+    if [ -f "tests/cases/$name.out" ] && ! cmp -s "$work/$name.out" "tests/cases/$name.out"; then ok=0; fi
+    if [ $ok -eq 1 ]; then echo "ok   $name"; else fail "$name"; fi
+done
+
+# Every output mode on one program: tests/formats/MODE.hex is the expected file
+for expected in tests/formats/*.hex; do
+    mode=$(basename "$expected" .hex)
+    if "$asm" tests/formats/prog.s "$work/$mode.fmt" "$mode" > /dev/null &&
+       cmp -s "$work/$mode.fmt" "$expected"; then
+        echo "ok   format $mode"
+    else
+        fail "format $mode"
+    fi
+done
+
+# %pcrel_lo across objects: the target sits 0x96C bytes past the auipc, so the
+# low part is negative and the high part has to round up
+{
+    echo ".globl target"
+    i=0; while [ $i -lt 600 ]; do echo "addi x0, x0, 0"; i=$((i + 1)); done
+    echo "target:"
+    echo "ecall"
+} > "$work/pcrel_data.s"
+"$asm" --link "$work/pcrel.hex" run tests/link/pcrel_main.s "$work/pcrel_data.s" > "$work/pcrel.log"
+if grep -q "exit with code 2412" "$work/pcrel.log"; then
+    echo "ok   link pcrel"
+else
+    fail "link pcrel"
+fi
+
+# --xlen applies to every object of a link
+"$asm" --link "$work/rv64.hex" word --xlen 64 tests/link/xlen_a.s tests/link/xlen_b.s > "$work/rv64.log"
+if [ "$(tr '\n' ' ' < "$work/rv64.hex" 2>/dev/null)" = "6B85D513 0805C63B 003100BB " ]; then
+    echo "ok   link xlen 64"
+else
+    fail "link xlen 64"
+fi
+if "$asm" --link "$work/rv32.hex" word tests/link/xlen_a.s tests/link/xlen_b.s > "$work/rv32.log" ||
+   ! grep -q "xlen_b.s:2: addw is not available on RV32" "$work/rv32.log"; then
+    fail "link xlen 32"
+else
+    echo "ok   link xlen 32"
+fi
+
+# An undefined symbol fails the link and leaves no output behind
+if "$asm" --link "$work/undef.hex" word tests/link/undefined.s > "$work/undef.log" ||
+   [ -e "$work/undef.hex" ] || ! grep -q "Undefined symbol: missing" "$work/undef.log"; then
+    fail "link undefined"
+else
+    echo "ok   link undefined"
+fi
+
+# --serve only ever replaces a stale socket, never another file
+echo keep > "$work/not_a_socket"
+if "$asm" --serve "$work/not_a_socket" > "$work/serve.log" ||
+   [ "$(cat "$work/not_a_socket")" != keep ] || ! grep -q "is not a socket" "$work/serve.log"; then
+    fail "serve path check"
+else
+    echo "ok   serve path check"
+fi
+
+[ $failures -eq 0 ] && echo "All tests passed" || echo "$failures test(s) failed"
+[ $failures -eq 0 ]